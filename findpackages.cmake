@@ -22,6 +22,12 @@ if (NOT Boost_FOUND)
     endif()
 endif ()
 
+#######################################################
+###                     THREADS                     ###
+#######################################################
+find_package(Threads REQUIRED)
+set(ALL_LIBRARIES ${ALL_LIBRARIES} Threads::Threads)
+
 #######################################################
 ###             POSTGRESQL LIBRARIES                ###
 #######################################################
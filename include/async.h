@@ -0,0 +1,117 @@
+//
+// Worker threads for the asynchronous entry points of the data objects
+//
+#ifndef WPP_ASYNC_H
+#define WPP_ASYNC_H
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace wpp {
+    namespace db {
+        ///////////////////////////////////////////////////////////////
+        //                         WORKER POOL                       //
+        ///////////////////////////////////////////////////////////////
+        // Threads running blocking calls. Tasks submitted with the same key (a connection) run one
+        // at a time and in order, while tasks of different keys run in parallel
+        class worker_pool {
+            public:
+                explicit worker_pool(size_t threads = std::max(2u, std::thread::hardware_concurrency())) {
+                    for (size_t i = 0; i < threads; ++i) {
+                        _threads.emplace_back([this]() { this->run(); });
+                    }
+                }
+
+                worker_pool(const worker_pool &) = delete;
+
+                worker_pool &operator=(const worker_pool &) = delete;
+
+                // Runs what was already submitted before joining
+                ~worker_pool() {
+                    {
+                        std::lock_guard<std::mutex> lock(_mutex);
+                        _stop = true;
+                    }
+                    _ready_cv.notify_all();
+                    for (std::thread &t : _threads) {
+                        t.join();
+                    }
+                }
+
+                // Pool shared by every data object without a reactor of its own
+                static worker_pool &shared() {
+                    static worker_pool pool;
+                    return pool;
+                }
+
+                template<typename F>
+                std::future<typename std::result_of<F()>::type> submit(const void *key, F &&task) {
+                    using return_type = typename std::result_of<F()>::type;
+                    std::shared_ptr<std::packaged_task<return_type()>> packaged =
+                            std::make_shared<std::packaged_task<return_type()>>(std::forward<F>(task));
+                    std::future<return_type> result = packaged->get_future();
+                    {
+                        std::lock_guard<std::mutex> lock(_mutex);
+                        strand &s = _strands[key];
+                        s.tasks.emplace_back([packaged]() { (*packaged)(); });
+                        /* an idle strand becomes ready; a busy one picks the task up when it is done */
+                        if (!s.scheduled) {
+                            s.scheduled = true;
+                            _ready.push_back(key);
+                            _ready_cv.notify_one();
+                        }
+                    }
+                    return result;
+                }
+
+                size_t size() const noexcept { return _threads.size(); }
+
+            protected:
+                struct strand {
+                    std::deque<std::function<void()>> tasks;
+                    bool scheduled{false};
+                };
+
+                void run() {
+                    std::unique_lock<std::mutex> lock(_mutex);
+                    for (;;) {
+                        _ready_cv.wait(lock, [this]() { return _stop || !_ready.empty(); });
+                        if (_ready.empty()) {
+                            return;
+                        }
+                        const void *key = _ready.front();
+                        _ready.pop_front();
+                        std::function<void()> task = std::move(_strands[key].tasks.front());
+                        _strands[key].tasks.pop_front();
+                        lock.unlock();
+                        task();
+                        lock.lock();
+                        strand &s = _strands[key];
+                        if (s.tasks.empty()) {
+                            _strands.erase(key);
+                        } else {
+                            _ready.push_back(key);
+                            _ready_cv.notify_one();
+                        }
+                    }
+                }
+
+                std::mutex _mutex;
+                std::condition_variable _ready_cv;
+                std::deque<const void *> _ready;
+                std::unordered_map<const void *, strand> _strands;
+                std::vector<std::thread> _threads;
+                bool _stop{false};
+        };
+    }
+}
+
+#endif //WPP_ASYNC_H
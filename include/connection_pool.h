@@ -0,0 +1,337 @@
+//
+// Pool of driver connections shared between threads
+//
+#ifndef WPP_CONNECTION_POOL_H
+#define WPP_CONNECTION_POOL_H
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "data_object.h"
+
+namespace wpp {
+    namespace db {
+        ///////////////////////////////////////////////////////////////
+        //                      CONNECTION POOL                      //
+        ///////////////////////////////////////////////////////////////
+        struct pool_options {
+            // connections opened up front and kept through idle eviction
+            size_t min_size{0};
+            // connections open at the same time, leased or idle
+            size_t max_size{8};
+            // idle connections older than this are closed (zero keeps them forever)
+            std::chrono::milliseconds idle_timeout{std::chrono::minutes(5)};
+            // how long acquire() waits for a connection when the pool is exhausted
+            std::chrono::milliseconds wait_timeout{std::chrono::seconds(30)};
+            // check_liveness() on every idle connection before it is handed out
+            bool validate_on_checkout{true};
+        };
+
+        // Hands out connections of a driver (sqlite_data_object, pgsql_data_object, ...) as leases.
+        // A connection is used by one lease at a time and goes back to the pool when the lease is
+        // destroyed. The lock only guards the idle list: connecting, validating and closing
+        // happen outside of it.
+        template<typename Driver>
+        class connection_pool {
+            public:
+                using factory_type = std::function<std::unique_ptr<Driver>()>;
+                using clock = std::chrono::steady_clock;
+
+            protected:
+                struct idle_connection {
+                    std::unique_ptr<Driver> conn;
+                    clock::time_point since;
+                };
+
+                struct state {
+                    factory_type factory;
+                    pool_options options;
+                    std::mutex mutex;
+                    std::condition_variable released;
+                    // most recently used at the back
+                    std::deque<idle_connection> idle;
+                    // leased, idle and being opened
+                    size_t open{0};
+                    bool closed{false};
+
+                    // moves connections idle for too long to expired, keeping min_size open
+                    void collect_expired(std::vector<std::unique_ptr<Driver>> &expired, clock::time_point now) {
+                        if (options.idle_timeout.count() <= 0) {
+                            return;
+                        }
+                        while (!idle.empty() && open > options.min_size &&
+                               now - idle.front().since >= options.idle_timeout) {
+                            expired.push_back(std::move(idle.front().conn));
+                            idle.pop_front();
+                            --open;
+                        }
+                    }
+                };
+
+            public:
+                ///////////////////////////////////////////////////////////////
+                //                           LEASE                           //
+                ///////////////////////////////////////////////////////////////
+                // A connection checked out of the pool. Empty when acquire() timed out
+                class lease {
+                    public:
+                        lease() = default;
+
+                        lease(const lease &) = delete;
+
+                        lease &operator=(const lease &) = delete;
+
+                        lease(lease &&other) noexcept = default;
+
+                        lease &operator=(lease &&other) noexcept {
+                            if (this != &other) {
+                                release();
+                                _pool = std::move(other._pool);
+                                _conn = std::move(other._conn);
+                            }
+                            return *this;
+                        }
+
+                        ~lease() { release(); }
+
+                        Driver *operator->() const noexcept { return _conn.get(); }
+
+                        Driver &operator*() const noexcept { return *_conn; }
+
+                        Driver *get() const noexcept { return _conn.get(); }
+
+                        explicit operator bool() const noexcept { return _conn != nullptr; }
+
+                        // Returns the connection to the pool, rolling back an open transaction
+                        void release() {
+                            if (!_conn) {
+                                return;
+                            }
+                            std::shared_ptr<state> pool = std::move(_pool);
+                            std::unique_ptr<Driver> conn = std::move(_conn);
+                            if (!connection_pool::reset(*conn)) {
+                                connection_pool::close(*pool, std::move(conn));
+                                return;
+                            }
+                            std::vector<std::unique_ptr<Driver>> expired;
+                            {
+                                std::lock_guard<std::mutex> lock(pool->mutex);
+                                if (pool->closed) {
+                                    --pool->open;
+                                    expired.push_back(std::move(conn));
+                                } else {
+                                    clock::time_point now = clock::now();
+                                    pool->collect_expired(expired, now);
+                                    pool->idle.push_back(idle_connection{std::move(conn), now});
+                                }
+                            }
+                            pool->released.notify_one();
+                        }
+
+                        // Closes the connection instead of returning it, e.g. after a fatal error
+                        void discard() {
+                            if (_conn) {
+                                connection_pool::close(*_pool, std::move(_conn));
+                                _pool.reset();
+                            }
+                        }
+
+                    protected:
+                        friend class connection_pool;
+
+                        lease(std::shared_ptr<state> pool, std::unique_ptr<Driver> conn)
+                                : _pool(std::move(pool)), _conn(std::move(conn)) {}
+
+                        std::shared_ptr<state> _pool;
+                        std::unique_ptr<Driver> _conn;
+                };
+
+                ///////////////////////////////////////////////////////////////
+                //                           POOL                            //
+                ///////////////////////////////////////////////////////////////
+                connection_pool(std::string data_source,
+                                std::string username = "",
+                                std::string passwd = "",
+                                std::unordered_map<attribute_type, driver_option> driver_options = {},
+                                pool_options options = {})
+                        : connection_pool([data_source, username, passwd, driver_options]() {
+                    return std::unique_ptr<Driver>(new Driver(data_source, username, passwd, driver_options));
+                }, options) {}
+
+                explicit connection_pool(factory_type factory, pool_options options = {})
+                        : _state(std::make_shared<state>()) {
+                    if (options.max_size == 0) {
+                        throw std::invalid_argument("connection_pool: max_size must be at least 1");
+                    }
+                    if (options.min_size > options.max_size) {
+                        options.min_size = options.max_size;
+                    }
+                    _state->factory = std::move(factory);
+                    _state->options = options;
+                    for (size_t i = 0; i < options.min_size; ++i) {
+                        std::unique_ptr<Driver> conn = connect(*_state);
+                        _state->idle.push_back(idle_connection{std::move(conn), clock::now()});
+                        ++_state->open;
+                    }
+                }
+
+                connection_pool(const connection_pool &) = delete;
+
+                connection_pool &operator=(const connection_pool &) = delete;
+
+                // Closes the idle connections. Leases still out close theirs when released
+                ~connection_pool() {
+                    std::deque<idle_connection> idle;
+                    {
+                        std::lock_guard<std::mutex> lock(_state->mutex);
+                        _state->closed = true;
+                        _state->open -= _state->idle.size();
+                        idle.swap(_state->idle);
+                    }
+                    _state->released.notify_all();
+                }
+
+                // Waits up to options.wait_timeout for a connection
+                lease acquire() {
+                    return acquire(_state->options.wait_timeout);
+                }
+
+                // Empty lease if no connection became available in time
+                lease acquire(std::chrono::milliseconds timeout) {
+                    const clock::time_point deadline = clock::now() + timeout;
+                    std::unique_lock<std::mutex> lock(_state->mutex);
+                    for (;;) {
+                        std::vector<std::unique_ptr<Driver>> expired;
+                        _state->collect_expired(expired, clock::now());
+                        if (!_state->idle.empty()) {
+                            /* LIFO keeps the hot connections hot and lets the cold ones expire */
+                            std::unique_ptr<Driver> conn = std::move(_state->idle.back().conn);
+                            _state->idle.pop_back();
+                            lock.unlock();
+                            expired.clear();
+                            if (!_state->options.validate_on_checkout || is_alive(*conn)) {
+                                return lease(_state, std::move(conn));
+                            }
+                            close(*_state, std::move(conn));
+                            lock.lock();
+                            continue;
+                        }
+                        if (_state->open < _state->options.max_size) {
+                            ++_state->open;
+                            lock.unlock();
+                            expired.clear();
+                            std::unique_ptr<Driver> conn;
+                            try {
+                                conn = connect(*_state);
+                            } catch (...) {
+                                close(*_state, nullptr);
+                                throw;
+                            }
+                            return lease(_state, std::move(conn));
+                        }
+                        if (!expired.empty()) {
+                            lock.unlock();
+                            expired.clear();
+                            lock.lock();
+                            continue;
+                        }
+                        if (_state->released.wait_until(lock, deadline) == std::cv_status::timeout &&
+                            _state->idle.empty() && _state->open >= _state->options.max_size) {
+                            return lease();
+                        }
+                    }
+                }
+
+                // Never waits
+                lease try_acquire() {
+                    return acquire(std::chrono::milliseconds(0));
+                }
+
+                // Closes the connections idle for longer than options.idle_timeout
+                void evict_idle() {
+                    std::vector<std::unique_ptr<Driver>> expired;
+                    {
+                        std::lock_guard<std::mutex> lock(_state->mutex);
+                        _state->collect_expired(expired, clock::now());
+                    }
+                    if (!expired.empty()) {
+                        _state->released.notify_all();
+                    }
+                }
+
+                // Open connections, leased or idle
+                size_t size() const {
+                    std::lock_guard<std::mutex> lock(_state->mutex);
+                    return _state->open;
+                }
+
+                size_t idle() const {
+                    std::lock_guard<std::mutex> lock(_state->mutex);
+                    return _state->idle.size();
+                }
+
+                const pool_options &options() const noexcept { return _state->options; }
+
+            protected:
+                static std::unique_ptr<Driver> connect(state &s) {
+                    std::unique_ptr<Driver> conn = s.factory();
+                    if (!conn) {
+                        throw std::runtime_error("connection_pool: the factory returned no connection");
+                    }
+                    data_object &dbh = *conn;
+                    if (dbh._error_code != "000000") {
+                        std::vector<std::string> info = dbh.error_info();
+                        throw std::runtime_error("connection_pool: could not connect: " + info.back());
+                    }
+                    return conn;
+                }
+
+                // Gives the slot of a connection back, closing the connection outside the lock
+                static void close(state &s, std::unique_ptr<Driver> conn) {
+                    conn.reset();
+                    {
+                        std::lock_guard<std::mutex> lock(s.mutex);
+                        --s.open;
+                    }
+                    s.released.notify_one();
+                }
+
+                // Drivers without check_liveness are assumed to be alive
+                static bool is_alive(Driver &conn) {
+                    data_object &dbh = conn;
+                    if (dbh.check_liveness()) {
+                        return true;
+                    }
+                    if (dbh._error_code == "IM001") {
+                        dbh._error_code = "000000";
+                        return true;
+                    }
+                    return false;
+                }
+
+                // Leaves the connection as the next lease expects it: no open transaction
+                static bool reset(Driver &conn) {
+                    data_object &dbh = conn;
+                    if (dbh.in_transaction_func()) {
+                        if (!dbh.rollback()) {
+                            return false;
+                        }
+                        dbh._in_txn = false;
+                    }
+                    dbh._error_code = "000000";
+                    return true;
+                }
+
+                std::shared_ptr<state> _state;
+        };
+    }
+}
+
+#endif //WPP_CONNECTION_POOL_H
@@ -5,18 +5,38 @@
 #define WPP_DATA_OBJECT_H
 
 #include <stdio.h>
+#include <cstdint>
+#include <cstdlib>
+#include <algorithm>
+#include <array>
 #include <sstream>
 #include <regex>
 #include <memory>
+#include <mutex>
 #include <type_traits>
 #include <typeinfo>
 #include <typeindex>
+#include <tuple>
+#include <utility>
+#include <list>
 #include <unordered_map>
 #include <boost/algorithm/string/replace.hpp>
 #include <boost/algorithm/string/case_conv.hpp>
 #include <boost/format.hpp>
 #include <boost/variant.hpp>
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+/* the scanner's SIMD paths are compiled per function and picked at run time */
+#define DATA_OBJECT_SCAN_DISPATCH
+#define DATA_OBJECT_TARGET(isa) __attribute__((target(isa)))
+#else
+#define DATA_OBJECT_TARGET(isa)
+#endif
+#if defined(DATA_OBJECT_SCAN_DISPATCH) || defined(__AVX2__) || defined(__SSE4_2__)
+#include <immintrin.h>
+#endif
 #include "result.h"
+#include "async.h"
+#include "sql_literal.h"
 
 namespace wpp {
     namespace db {
@@ -31,6 +51,26 @@ namespace wpp {
             PARAM_FLOAT,
             PARAM_LOB
         };
+        // C++ type of a bound variable, taken when it is bound so that conversions are a switch
+        enum value_tag {
+            VALUE_OTHER,
+            VALUE_CHAR,
+            VALUE_SHORT,
+            VALUE_INT,
+            VALUE_LONG,
+            VALUE_LONG_LONG,
+            VALUE_UNSIGNED_CHAR,
+            VALUE_UNSIGNED_SHORT,
+            VALUE_UNSIGNED_INT,
+            VALUE_UNSIGNED_LONG,
+            VALUE_UNSIGNED_LONG_LONG,
+            VALUE_FLOAT,
+            VALUE_DOUBLE,
+            VALUE_LONG_DOUBLE,
+            VALUE_BOOL,
+            VALUE_STRING,
+            VALUE_NULL
+        };
         enum fetch_orientation {
             FETCH_ORI_NEXT,
             FETCH_ORI_PRIOR,
@@ -62,6 +102,7 @@ namespace wpp {
             ATTR_DEFAULT_FETCH_MODE,
             ATTR_EMULATE_PREPARES,
             ATTR_DEFAULT_STR_PARAM,
+            ATTR_STATEMENT_CACHE,
             ATTR_DRIVER_SPECIFIC = 1000
         };
         enum cursor_type {
@@ -170,14 +211,39 @@ namespace wpp {
         class data_object_statement;
 
         struct bound_param_data {
-            void *parameter;
-            std::type_index parameter_typeinfo{typeid(std::string)};
+            void *parameter{nullptr};
+            value_tag parameter_tag{VALUE_STRING};
             std::unique_ptr<std::string> parameter_data;                /* the variable itself (for bind_value) */
+            /* bind_value copies of integers, reals and booleans, kept as they are rather than as text */
+            int64_t int_value{0};
+            double real_value{0};
+            bool bool_value{false};
+            bool is_native_copy{false};
             long paramno{-1}; /* if -1, then it has a name, and we don't know the index *yet* */
             std::string name;
             data_object_statement *stmt;
             enum param_type param_type;
             bool is_param;
+
+            // The native copy lives inside the struct, so the pointer is refreshed whenever it moves
+            void point_to_native() {
+                if (!is_native_copy) {
+                    return;
+                }
+                switch (param_type) {
+                    case PARAM_INT:
+                        parameter = &int_value;
+                        break;
+                    case PARAM_FLOAT:
+                        parameter = &real_value;
+                        break;
+                    case PARAM_BOOL:
+                        parameter = &bool_value;
+                        break;
+                    default:
+                        parameter = nullptr;
+                }
+            }
         };
         struct scanner {
             char *ptr;
@@ -185,6 +251,147 @@ namespace wpp {
             char *tok;
             char *end;
         };
+        // Instruction sets scan_until_any can use, best first
+        enum scan_simd_level {
+            SCAN_SCALAR = 0,
+            SCAN_SSE42 = 1,
+            SCAN_AVX2 = 2
+        };
+
+        // Best level of this CPU. With GCC or Clang on x86 it is checked once at run time, so the
+        // SIMD paths run without -msse4.2/-mavx2. Elsewhere it comes from the compile flags
+        inline scan_simd_level best_scan_simd_level() {
+            #if defined(DATA_OBJECT_SCAN_DISPATCH)
+            static const scan_simd_level level = __builtin_cpu_supports("avx2") ? SCAN_AVX2
+                                               : __builtin_cpu_supports("sse4.2") ? SCAN_SSE42 : SCAN_SCALAR;
+            return level;
+            #elif defined(__AVX2__)
+            return SCAN_AVX2;
+            #elif defined(__SSE4_2__)
+            return SCAN_SSE42;
+            #else
+            return SCAN_SCALAR;
+            #endif
+        }
+
+        // First byte in [cursor, end) that is one of Stops, or end, one byte at a time
+        template<char... Stops>
+        inline char *scan_until_any_scalar(char *cursor, char *end) {
+            static const std::array<bool, 256> is_stop = []() {
+                std::array<bool, 256> table{};
+                const char stops[] = {Stops...};
+                for (char c : stops) {
+                    table[(unsigned char) c] = true;
+                }
+                return table;
+            }();
+            while (cursor < end && !is_stop[(unsigned char) *cursor]) {
+                ++cursor;
+            }
+            return cursor;
+        }
+
+        #if defined(DATA_OBJECT_SCAN_DISPATCH) || defined(__SSE4_2__) || defined(__AVX2__)
+        // Index of the first of the n stops in the 16 bytes at p, or 16. The lengths are explicit,
+        // so that a NUL among the stops is matched instead of ending the set
+        DATA_OBJECT_TARGET("sse4.2")
+        inline int find_any_in_16(__m128i set, int n, const char *p) {
+            return _mm_cmpestri(set, n, _mm_loadu_si128(reinterpret_cast<const __m128i *>(p)), 16,
+                                _SIDD_UBYTE_OPS | _SIDD_CMP_EQUAL_ANY);
+        }
+
+        // Same as scan_until_any_scalar, testing 16 bytes at a time
+        template<char... Stops>
+        DATA_OBJECT_TARGET("sse4.2")
+        inline char *scan_until_any_sse42(char *cursor, char *end) {
+            static_assert(sizeof...(Stops) <= 16, "at most 16 stop bytes");
+            alignas(16) static const char padded[16] = {Stops...};
+            const __m128i set = _mm_load_si128(reinterpret_cast<const __m128i *>(padded));
+            while (end - cursor >= 16) {
+                const int first = find_any_in_16(set, (int) sizeof...(Stops), cursor);
+                if (first < 16) {
+                    return cursor + first;
+                }
+                cursor += 16;
+            }
+            return scan_until_any_scalar<Stops...>(cursor, end);
+        }
+
+        // Same as scan_until_any_scalar, testing 16 and then 32 bytes at a time
+        template<char... Stops>
+        DATA_OBJECT_TARGET("avx2,sse4.2")
+        inline char *scan_until_any_avx2(char *cursor, char *end) {
+            static_assert(sizeof...(Stops) <= 16, "at most 16 stop bytes");
+            alignas(16) static const char padded[16] = {Stops...};
+            /* most runs are short: try 16 bytes before paying for the wider setup */
+            if (end - cursor >= 16) {
+                const __m128i set = _mm_load_si128(reinterpret_cast<const __m128i *>(padded));
+                const int first = find_any_in_16(set, (int) sizeof...(Stops), cursor);
+                if (first < 16) {
+                    return cursor + first;
+                }
+                cursor += 16;
+            }
+            if (end - cursor >= 32) {
+                const __m256i needles[] = {_mm256_set1_epi8(Stops)...};
+                do {
+                    const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(cursor));
+                    __m256i hits = _mm256_setzero_si256();
+                    for (const __m256i &needle : needles) {
+                        hits = _mm256_or_si256(hits, _mm256_cmpeq_epi8(chunk, needle));
+                    }
+                    const unsigned mask = (unsigned) _mm256_movemask_epi8(hits);
+                    if (mask) {
+                        #if defined(_MSC_VER)
+                        unsigned long first;
+                        _BitScanForward(&first, mask);
+                        return cursor + first;
+                        #else
+                        return cursor + __builtin_ctz(mask);
+                        #endif
+                    }
+                    cursor += 32;
+                } while (end - cursor >= 32);
+            }
+            return scan_until_any_sse42<Stops...>(cursor, end);
+        }
+        #endif
+
+        // First byte in [cursor, end) that is one of Stops, or end, with the given instruction set
+        // (capped at what this build can emit)
+        template<char... Stops>
+        inline char *scan_until_any(char *cursor, char *end, scan_simd_level level) {
+            #if defined(DATA_OBJECT_SCAN_DISPATCH) || defined(__AVX2__)
+            if (level >= SCAN_AVX2) {
+                return scan_until_any_avx2<Stops...>(cursor, end);
+            }
+            #endif
+            #if defined(DATA_OBJECT_SCAN_DISPATCH) || defined(__SSE4_2__) || defined(__AVX2__)
+            if (level >= SCAN_SSE42) {
+                return scan_until_any_sse42<Stops...>(cursor, end);
+            }
+            #endif
+            return scan_until_any_scalar<Stops...>(cursor, end);
+        }
+
+        template<char... Stops>
+        inline char *scan_until_any(char *cursor, char *end) {
+            return scan_until_any<Stops...>(cursor, end, best_scan_simd_level());
+        }
+
+        // Bytes that end a run of plain text or of a quoted string in data_object_statement::scan
+        inline char *scan_text_run(char *cursor, char *end) {
+            return scan_until_any<'\0', '"', '\'', '(', ')', '*', '+', ',', '-', '.', '/', ':', '?'>(cursor, end);
+        }
+
+        inline char *scan_single_quoted(char *cursor, char *end) {
+            return scan_until_any<'\0', '\'', '\\'>(cursor, end);
+        }
+
+        inline char *scan_double_quoted(char *cursor, char *end) {
+            return scan_until_any<'\0', '"', '\\'>(cursor, end);
+        }
+
         struct placeholder {
             std::string unquoted;
             size_t position_in_query;
@@ -192,6 +399,146 @@ namespace wpp {
             std::string quoted;
             int freeq = 1;
         };
+
+        // What parse_params found in a query: the placeholders and, when it does not depend on the
+        // bound values, the rewritten query
+        struct parsed_query {
+            int query_type{0};
+            std::vector<placeholder> placeholders;
+            // -1 while the rewrite is unknown, otherwise what parse_params returns
+            int ret{-1};
+            std::string outquery;
+            bool rewrites_param_map{false};
+            std::unordered_map<std::string, std::string> bound_param_map;
+        };
+
+        // Process-wide, so every connection and statement preparing the same text shares the work.
+        // Bounded by entries and by bytes, least recently used evicted first. Queries longer than
+        // max_query_size (e.g. generated multi-row INSERTs) are rarely repeated and are not kept
+        class parsed_query_cache {
+            public:
+                static parsed_query_cache &shared() {
+                    static parsed_query_cache cache;
+                    return cache;
+                }
+
+                static std::string key(const std::string &query, int supports_placeholders,
+                                       const std::string &rewrite_template) {
+                    return std::to_string(supports_placeholders) + '\0' + rewrite_template + '\0' + query;
+                }
+
+                // Entry with only the placeholders, which do not depend on the driver
+                static std::string scan_key(const std::string &query) {
+                    return key(query, PLACEHOLDER_NONE, "");
+                }
+
+                std::shared_ptr<const parsed_query> find(const std::string &key) {
+                    std::lock_guard<std::mutex> lock(_mutex);
+                    auto iter = _index.find(key);
+                    if (iter == _index.end()) {
+                        return nullptr;
+                    }
+                    _entries.splice(_entries.begin(), _entries, iter->second);
+                    return iter->second->parsed;
+                }
+
+                void insert(const std::string &key, std::shared_ptr<const parsed_query> parsed) {
+                    const size_t bytes = footprint(key, *parsed);
+                    std::lock_guard<std::mutex> lock(_mutex);
+                    if (_capacity == 0 || key.size() > _max_query_size || bytes > _max_bytes) {
+                        return;
+                    }
+                    auto iter = _index.find(key);
+                    if (iter != _index.end()) {
+                        _bytes -= iter->second->bytes;
+                        _entries.erase(iter->second);
+                        _index.erase(iter);
+                    }
+                    _entries.push_front(entry{key, std::move(parsed), bytes});
+                    _index[key] = _entries.begin();
+                    _bytes += bytes;
+                    this->shrink();
+                }
+
+                // Most entries kept
+                void capacity(size_t n) {
+                    std::lock_guard<std::mutex> lock(_mutex);
+                    _capacity = n;
+                    this->shrink();
+                }
+
+                // Most bytes kept, counting the query text and what was parsed from it
+                void max_bytes(size_t n) {
+                    std::lock_guard<std::mutex> lock(_mutex);
+                    _max_bytes = n;
+                    this->shrink();
+                }
+
+                // Longer queries are parsed every time
+                void max_query_size(size_t n) {
+                    std::lock_guard<std::mutex> lock(_mutex);
+                    _max_query_size = n;
+                }
+
+                // Whether a query this long is looked up at all. Checked before building its key, so that
+                // large generated statements are not copied and hashed for entries that are never kept
+                bool caches(size_t query_size) const {
+                    std::lock_guard<std::mutex> lock(_mutex);
+                    return _capacity != 0 && query_size <= _max_query_size;
+                }
+
+                size_t size() const {
+                    std::lock_guard<std::mutex> lock(_mutex);
+                    return _entries.size();
+                }
+
+                size_t bytes() const {
+                    std::lock_guard<std::mutex> lock(_mutex);
+                    return _bytes;
+                }
+
+                void clear() {
+                    std::lock_guard<std::mutex> lock(_mutex);
+                    _index.clear();
+                    _entries.clear();
+                    _bytes = 0;
+                }
+
+            protected:
+                struct entry {
+                    std::string key;
+                    std::shared_ptr<const parsed_query> parsed;
+                    size_t bytes;
+                };
+
+                static size_t footprint(const std::string &key, const parsed_query &parsed) {
+                    size_t bytes = sizeof(entry) + sizeof(parsed_query) + 2 * key.size() + parsed.outquery.size();
+                    for (const placeholder &p : parsed.placeholders) {
+                        bytes += sizeof(placeholder) + p.unquoted.size() + p.quoted.size();
+                    }
+                    for (const std::pair<const std::string, std::string> &item : parsed.bound_param_map) {
+                        bytes += item.first.size() + item.second.size();
+                    }
+                    return bytes;
+                }
+
+                void shrink() {
+                    while (!_entries.empty() && (_entries.size() > _capacity || _bytes > _max_bytes)) {
+                        _bytes -= _entries.back().bytes;
+                        _index.erase(_entries.back().key);
+                        _entries.pop_back();
+                    }
+                }
+
+                mutable std::mutex _mutex;
+                size_t _capacity{4096};
+                size_t _max_bytes{16 * 1024 * 1024};
+                size_t _max_query_size{64 * 1024};
+                size_t _bytes{0};
+                // most recently used first
+                std::list<entry> _entries;
+                std::unordered_map<std::string, std::list<entry>::iterator> _index;
+        };
         ///////////////////////////////////////////////////////////////
         //                    META-PROGRAMMING HELPERS               //
         ///////////////////////////////////////////////////////////////
@@ -256,11 +603,245 @@ namespace wpp {
                 enum { value = sizeof(test<T>(0)) == sizeof(char) };
         };
 
+        template<typename T>
+        struct value_tag_of : std::integral_constant<value_tag, VALUE_OTHER> {
+        };
+        template<typename T>
+        struct value_tag_of<const T> : value_tag_of<T> {
+        };
+        template<>
+        struct value_tag_of<char> : std::integral_constant<value_tag, VALUE_CHAR> {
+        };
+        template<>
+        struct value_tag_of<short> : std::integral_constant<value_tag, VALUE_SHORT> {
+        };
+        template<>
+        struct value_tag_of<int> : std::integral_constant<value_tag, VALUE_INT> {
+        };
+        template<>
+        struct value_tag_of<long> : std::integral_constant<value_tag, VALUE_LONG> {
+        };
+        template<>
+        struct value_tag_of<long long> : std::integral_constant<value_tag, VALUE_LONG_LONG> {
+        };
+        template<>
+        struct value_tag_of<unsigned char> : std::integral_constant<value_tag, VALUE_UNSIGNED_CHAR> {
+        };
+        template<>
+        struct value_tag_of<unsigned short> : std::integral_constant<value_tag, VALUE_UNSIGNED_SHORT> {
+        };
+        template<>
+        struct value_tag_of<unsigned int> : std::integral_constant<value_tag, VALUE_UNSIGNED_INT> {
+        };
+        template<>
+        struct value_tag_of<unsigned long> : std::integral_constant<value_tag, VALUE_UNSIGNED_LONG> {
+        };
+        template<>
+        struct value_tag_of<unsigned long long> : std::integral_constant<value_tag, VALUE_UNSIGNED_LONG_LONG> {
+        };
+        template<>
+        struct value_tag_of<float> : std::integral_constant<value_tag, VALUE_FLOAT> {
+        };
+        template<>
+        struct value_tag_of<double> : std::integral_constant<value_tag, VALUE_DOUBLE> {
+        };
+        template<>
+        struct value_tag_of<long double> : std::integral_constant<value_tag, VALUE_LONG_DOUBLE> {
+        };
+        template<>
+        struct value_tag_of<bool> : std::integral_constant<value_tag, VALUE_BOOL> {
+        };
+        template<>
+        struct value_tag_of<std::string> : std::integral_constant<value_tag, VALUE_STRING> {
+        };
+        template<>
+        struct value_tag_of<std::nullptr_t> : std::integral_constant<value_tag, VALUE_NULL> {
+        };
+
+        constexpr bool is_integer_tag(value_tag tag) {
+            return tag >= VALUE_CHAR && tag <= VALUE_UNSIGNED_LONG_LONG;
+        }
+
+        constexpr bool is_floating_tag(value_tag tag) {
+            return tag >= VALUE_FLOAT && tag <= VALUE_LONG_DOUBLE;
+        }
+
+        constexpr param_type param_type_of(value_tag tag) {
+            return is_integer_tag(tag) ? PARAM_INT :
+                   is_floating_tag(tag) ? PARAM_FLOAT :
+                   tag == VALUE_BOOL ? PARAM_BOOL :
+                   tag == VALUE_NULL ? PARAM_NULL : PARAM_STR;
+        }
+
+        ///////////////////////////////////////////////////////////////
+        //                         ROW MAPPING                       //
+        ///////////////////////////////////////////////////////////////
+        // Column name -> member pointer, for mapping result rows into user types
+        template<typename C, typename M>
+        struct member_mapping {
+            const char *name;
+            M C::*member;
+        };
+
+        template<typename C, typename M>
+        constexpr member_mapping<C, M> map_column(const char *name, M C::*member) {
+            return member_mapping<C, M>{name, member};
+        }
+
+        // Specialize with a static members() returning a tuple of map_column(...) to use fetch_into<T>:
+        //     template<> struct row_mapping<employee> {
+        //         static auto members() { return std::make_tuple(map_column("id", &employee::id), ...); }
+        //     };
+        template<typename T>
+        struct row_mapping;
+
+        // Decode a cell straight from the driver view into the destination
+        template<typename T>
+        typename std::enable_if<is_pure_int<T>::value>::type decode_field(const field_view &v, T &dest) {
+            dest = std::is_unsigned<T>::value ? T(v.get_uint()) : T(v.get_int());
+        }
+
+        template<typename T>
+        typename std::enable_if<std::is_floating_point<T>::value>::type decode_field(const field_view &v, T &dest) {
+            dest = T(v.get_real());
+        }
+
+        template<typename T>
+        typename std::enable_if<is_bool<T>::value>::type decode_field(const field_view &v, T &dest) {
+            dest = v.get_bool();
+        }
+
+        inline void decode_field(const field_view &v, std::string &dest) {
+            if (v.data() || v.type() == STRING) {
+                dest.assign(v.data(), v.size());
+            } else {
+                dest = v.to_string();
+            }
+        }
+
+        inline void decode_field(const field_view &v, field &dest) {
+            dest = field(v);
+        }
+
+        // Column positions and decoding for a mapped type
+        template<typename T>
+        struct row_mapper {
+            typedef decltype(row_mapping<T>::members()) members_type;
+
+            static constexpr size_t size = std::tuple_size<members_type>::value;
+
+            // one entry per member, schema.size() when the column does not exist
+            static void resolve(const row_schema &schema, std::vector<size_t> &positions) {
+                resolve(schema, positions, std::make_index_sequence<size>());
+            }
+
+            template<typename Getter>
+            static void decode(T &dest, const std::vector<size_t> &positions, Getter &&get) {
+                decode(dest, positions, get, std::make_index_sequence<size>());
+            }
+
+            protected:
+                static const members_type &members() {
+                    static const members_type m = row_mapping<T>::members();
+                    return m;
+                }
+
+                template<size_t... I>
+                static void resolve(const row_schema &schema, std::vector<size_t> &positions,
+                                    std::index_sequence<I...>) {
+                    positions = {schema.column_number(std::get<I>(members()).name)...};
+                }
+
+                template<typename Getter, size_t... I>
+                static void decode(T &dest, const std::vector<size_t> &positions, Getter &get,
+                                   std::index_sequence<I...>) {
+                    const members_type &m = members();
+                    int expand[] = {0, (decode_field(get(positions[I]), dest.*(std::get<I>(m).member)), 0)...};
+                    (void) expand;
+                }
+        };
+
+        // Tuples map positionally: element i is column i
+        template<typename... Ts>
+        struct row_mapper<std::tuple<Ts...>> {
+            static constexpr size_t size = sizeof...(Ts);
+
+            static void resolve(const row_schema &schema, std::vector<size_t> &positions) {
+                positions.clear();
+                for (size_t i = 0; i < size; ++i) {
+                    positions.push_back(i < schema.size() ? i : schema.size());
+                }
+            }
+
+            template<typename Getter>
+            static void decode(std::tuple<Ts...> &dest, const std::vector<size_t> &positions, Getter &&get) {
+                decode(dest, positions, get, std::index_sequence_for<Ts...>());
+            }
+
+            protected:
+                template<typename Getter, size_t... I>
+                static void decode(std::tuple<Ts...> &dest, const std::vector<size_t> &positions, Getter &get,
+                                   std::index_sequence<I...>) {
+                    int expand[] = {0, (decode_field(get(positions[I]), std::get<I>(dest)), 0)...};
+                    (void) expand;
+                }
+        };
+
+        ///////////////////////////////////////////////////////////////
+        //                        BATCH COLUMNS                      //
+        ///////////////////////////////////////////////////////////////
+        // A non-owning span with the values of one placeholder for every row of a batch
+        class batch_column {
+            public:
+                template<typename T, typename std::enable_if<
+                        is_pure_int<T>::value && (sizeof(T) == 4 || sizeof(T) == 8), int>::type = 0>
+                batch_column(const T *data, size_t size) :
+                        _type(PARAM_INT), _data(data), _size(size), _width(sizeof(T)),
+                        _is_unsigned(std::is_unsigned<T>::value) {
+                    static_assert(!(std::is_unsigned<T>::value && sizeof(T) == 8),
+                                  "batch columns are bound as int64: use int64_t or strings for 64-bit unsigned values");
+                }
+
+                batch_column(const double *data, size_t size) :
+                        _type(PARAM_FLOAT), _data(data), _size(size), _width(sizeof(double)) {}
+
+                batch_column(const std::string *data, size_t size) :
+                        _type(PARAM_STR), _data(data), _size(size), _width(sizeof(std::string)) {}
+
+                template<typename T>
+                batch_column(const std::vector<T> &values) : batch_column(values.data(), values.size()) {}
+
+                param_type type() const noexcept { return _type; }
+
+                size_t size() const noexcept { return _size; }
+
+                int64_t get_int(size_t n) const {
+                    if (_width == 8) {
+                        return ((const int64_t *) _data)[n];
+                    }
+                    return _is_unsigned ? int64_t(((const uint32_t *) _data)[n]) : int64_t(((const int32_t *) _data)[n]);
+                }
+
+                double get_real(size_t n) const { return ((const double *) _data)[n]; }
+
+                const std::string &get_string(size_t n) const { return ((const std::string *) _data)[n]; }
+
+            protected:
+                param_type _type;
+                const void *_data;
+                size_t _size;
+                size_t _width;
+                bool _is_unsigned{false};
+        };
+
         ///////////////////////////////////////////////////////////////
         //                    STATEMENT DECLARATION                  //
         ///////////////////////////////////////////////////////////////
         class data_object;
 
+        template<typename Driver>
+        class connection_pool;
+
         class data_object_statement {
             public:
                 friend data_object;
@@ -289,12 +870,42 @@ namespace wpp {
 
                 bool execute(std::vector<std::pair<std::string, std::string>> input_parameters = {});
 
+                // Execute once per row, column i binding placeholder i + 1
+                bool execute_batch(const std::vector<batch_column> &columns);
+
+                // Same as execute, without blocking the caller. The statement and its connection must not be
+                // used until the future is ready
+                virtual std::future<bool> execute_async(std::vector<std::pair<std::string, std::string>> input_parameters = {});
+
                 wpp::db::row fetch(fetch_orientation orientation = fetch_orientation::FETCH_ORI_NEXT, long offset = 0);
 
+                // Views into the driver buffers, valid until the next fetch. Numbers and booleans the driver
+                // fetched natively carry no text: str() is empty, but == and to_string() format them
+                wpp::db::row_view fetch_view(fetch_orientation orientation = fetch_orientation::FETCH_ORI_NEXT,
+                                             long offset = 0);
+
                 wpp::db::field fetch_column(long column_number = 0);
 
+                wpp::db::field fetch_column(column_handle &column);
+
                 wpp::db::result fetch_all();
 
+                wpp::db::columnar_result fetch_all_columnar();
+
+                std::future<wpp::db::result> fetch_all_async();
+
+                // Decode the next row into a mapped type (see row_mapping) or a std::tuple
+                template<typename T>
+                bool fetch_into(T &destination,
+                                fetch_orientation orientation = fetch_orientation::FETCH_ORI_NEXT,
+                                long offset = 0);
+
+                template<typename T>
+                T fetch_into(fetch_orientation orientation = fetch_orientation::FETCH_ORI_NEXT, long offset = 0);
+
+                template<typename T>
+                std::vector<T> fetch_all_as();
+
                 long row_count() { return _row_count; };
 
                 std::string error_code() { return _error_code; };
@@ -343,29 +954,50 @@ namespace wpp {
                 ///////////////////////////////////////////////////////////////
                 virtual int executer();
 
+                virtual int batch_executer(const std::vector<batch_column> &columns, size_t rows);
+
                 virtual int fetcher(fetch_orientation ori, long offset);
 
                 virtual int describer(int colno);
 
                 virtual int get_col(int colno, std::string &ptr, int &caller_frees);
 
+                virtual int col_is_null(int colno);
+
+                virtual int get_col_view(int colno, field_view &value);
+
                 virtual int param_hook(bound_param_data &attr, param_event val);
 
                 virtual int set_attribute_func(long attr, driver_option &val);
 
                 virtual int get_attribute(long attr, driver_option &val);
 
+                // Current value of an attribute, without raising errors: 1 if the driver knows it, 0 if not
+                virtual int peek_attribute(long attr, driver_option &val);
+
                 virtual int get_column_meta(long colno, column_data &return_value);
 
                 virtual int next_rowset_func();
 
                 virtual int cursor_closer();
 
+                // Leaves a statement as the preparer did, before it is handed out again by the statement cache
+                virtual int resetter();
+
+                // Puts back the attributes changed with set_attribute since prepare; 0 if one of them has no
+                // known value from prepare, and the statement must not be reused
+                int restore_prepared_attributes();
+
                 ///////////////////////////////////////////////////////////////
                 //       AUXILIARY FUNCTION THAT DO MOST OF THE REAL WORK    //
                 ///////////////////////////////////////////////////////////////
                 int parse_params(std::string &inquery, std::string &outquery);
 
+                static void scan_params(std::string &inquery, parsed_query &parsed);
+
+                int rewrite_params(std::string &inquery, std::string &outquery, int query_type,
+                                   std::vector<placeholder> &placeholders);
+
                 int dispatch_param_event(param_event event_type);
 
                 int do_fetch(bool do_bind,
@@ -375,8 +1007,6 @@ namespace wpp {
 
                 int do_fetch_common(enum fetch_orientation ori, long offset, bool do_bind);
 
-                void fetch_value(std::unique_ptr<std::string> &dest, int colno);
-
                 int generic_stmt_attr_get(driver_option &return_value, attribute_type attr);
 
                 int generic_stmt_attr_get(driver_option &return_value, long attr);
@@ -399,10 +1029,15 @@ namespace wpp {
 
                 static int scan(scanner *s);
 
+                static data_type column_data_type(param_type type);
+
                 void map_the_name_to_column(bound_param_data &param);
 
                 void update_bound_columns();
 
+                template<typename T>
+                const std::vector<size_t> *mapped_positions();
+
                 template<typename P, typename T>
                 int register_bound_param(P param_no_or_name, T &parameter, const bool is_param, const bool make_copy) {
                     bound_param_data param;
@@ -410,13 +1045,10 @@ namespace wpp {
                         return false;
                     }
                     if (make_copy) {
-                        param.parameter_data.reset(new std::string(std::move(data_object_statement::to_string<T>(parameter))));
-                        param.parameter = (void *) (param.parameter_data.get());
-                        param.parameter_typeinfo = typeid(std::string);
-                        param.param_type = PARAM_STR;
+                        this->copy_value<T>(param, parameter);
                     } else {
                         param.parameter = (void *) (&parameter);
-                        param.parameter_typeinfo = typeid(T);
+                        param.parameter_tag = value_tag_of<T>::value;
                         param.param_type = data_object_param_type<T>();
                     }
                     if (!this->really_register_bound_param(param, is_param)) {
@@ -425,120 +1057,199 @@ namespace wpp {
                     return true;
                 }
 
-                bool is_integer_hash(const size_t t) {
-                    return t == typeid(char).hash_code() ||
-                           t == typeid(short int).hash_code() ||
-                           t == typeid(int).hash_code() ||
-                           t == typeid(long int).hash_code() ||
-                           t == typeid(long long int).hash_code() ||
-                           t == typeid(unsigned char).hash_code() ||
-                           t == typeid(unsigned short int).hash_code() ||
-                           t == typeid(unsigned int).hash_code() ||
-                           t == typeid(unsigned long int).hash_code() ||
-                           t == typeid(unsigned long long int).hash_code();
-                }
-
-                bool is_floating_hash(const size_t t) {
-                    return t == typeid(float).hash_code() ||
-                           t == typeid(double).hash_code() ||
-                           t == typeid(long double).hash_code();
-                }
-
-                bool is_bool_hash(const size_t t) {
-                    return t == typeid(bool).hash_code();
-                }
-
-                bool is_string_hash(const size_t t) {
-                    return t == typeid(std::string).hash_code();
-                }
-
-                bool is_nullptr_hash(const size_t t) {
-                    return t == typeid(std::nullptr_t).hash_code();
-                }
-
-                std::string byte_to_string(const std::type_index t, void *data) {
-                    if (t.hash_code() == typeid(char).hash_code()) {
-                        return std::to_string(*((char *) data));
-                    } else if (t.hash_code() == typeid(short int).hash_code()) {
-                        return std::to_string(*((short int *) data));
-                    } else if (t.hash_code() == typeid(int).hash_code()) {
-                        return std::to_string(*((int *) data));
-                    } else if (t.hash_code() == typeid(long int).hash_code()) {
-                        return std::to_string(*((long int *) data));
-                    } else if (t.hash_code() == typeid(long long int).hash_code()) {
-                        return std::to_string(*((long long int *) data));
-                    } else if (t.hash_code() == typeid(unsigned char).hash_code()) {
-                        return std::to_string(*((unsigned char *) data));
-                    } else if (t.hash_code() == typeid(unsigned short int).hash_code()) {
-                        return std::to_string(*((unsigned short int *) data));
-                    } else if (t.hash_code() == typeid(unsigned int).hash_code()) {
-                        return std::to_string(*((unsigned int *) data));
-                    } else if (t.hash_code() == typeid(unsigned long int).hash_code()) {
-                        return std::to_string(*((unsigned long int *) data));
-                    } else if (t.hash_code() == typeid(unsigned long long int).hash_code()) {
-                        return std::to_string(*((unsigned long long int *) data));
-                    } else if (t.hash_code() == typeid(float).hash_code()) {
-                        return std::to_string(*((float *) data));
-                    } else if (t.hash_code() == typeid(double).hash_code()) {
-                        return std::to_string(*((double *) data));
-                    } else if (t.hash_code() == typeid(long double).hash_code()) {
-                        return std::to_string(*((long double *) data));
-                    } else if (t.hash_code() == typeid(bool).hash_code()) {
-                        return std::to_string(*((bool *) data));
-                    } else if (t.hash_code() == typeid(std::string).hash_code()) {
-                        return *((std::string *) data);
-                    } else {
-                        return "";
+                // Integers that fit in 64 bits, reals and booleans are copied natively, the rest as text
+                template<typename T>
+                typename std::enable_if<is_pure_int<T>::value && (std::is_signed<T>::value || sizeof(T) < 8)>::type
+                copy_value(bound_param_data &param, const T &value) {
+                    param.int_value = (int64_t) value;
+                    param.parameter_tag = value_tag_of<int64_t>::value;
+                    param.param_type = PARAM_INT;
+                    param.is_native_copy = true;
+                    param.point_to_native();
+                }
+
+                template<typename T>
+                typename std::enable_if<std::is_floating_point<T>::value>::type
+                copy_value(bound_param_data &param, const T &value) {
+                    param.real_value = (double) value;
+                    param.parameter_tag = VALUE_DOUBLE;
+                    param.param_type = PARAM_FLOAT;
+                    param.is_native_copy = true;
+                    param.point_to_native();
+                }
+
+                template<typename T>
+                typename std::enable_if<is_bool<T>::value>::type
+                copy_value(bound_param_data &param, const T &value) {
+                    param.bool_value = value;
+                    param.parameter_tag = VALUE_BOOL;
+                    param.param_type = PARAM_BOOL;
+                    param.is_native_copy = true;
+                    param.point_to_native();
+                }
+
+                template<typename T>
+                typename std::enable_if<std::is_same<T, std::nullptr_t>::value>::type
+                copy_value(bound_param_data &param, const T &) {
+                    param.parameter = nullptr;
+                    param.parameter_tag = VALUE_NULL;
+                    param.param_type = PARAM_NULL;
+                }
+
+                template<typename T>
+                typename std::enable_if<!(is_pure_int<T>::value && (std::is_signed<T>::value || sizeof(T) < 8)) &&
+                                        !std::is_floating_point<T>::value && !is_bool<T>::value &&
+                                        !std::is_same<T, std::nullptr_t>::value>::type
+                copy_value(bound_param_data &param, T &value) {
+                    param.parameter_data.reset(new std::string(std::move(data_object_statement::to_string<T>(value))));
+                    param.parameter = (void *) (param.parameter_data.get());
+                    param.parameter_tag = VALUE_STRING;
+                    param.param_type = PARAM_STR;
+                }
+
+                // Value of a bound integer, real or boolean, whatever type it was bound with
+                template<typename Out>
+                static Out param_as(const bound_param_data &param) {
+                    const void *p = param.parameter;
+                    if (!p) {
+                        return Out(0);
+                    }
+                    switch (param.parameter_tag) {
+                        case VALUE_CHAR:
+                            return (Out) *(const char *) p;
+                        case VALUE_SHORT:
+                            return (Out) *(const short *) p;
+                        case VALUE_INT:
+                            return (Out) *(const int *) p;
+                        case VALUE_LONG:
+                            return (Out) *(const long *) p;
+                        case VALUE_LONG_LONG:
+                            return (Out) *(const long long *) p;
+                        case VALUE_UNSIGNED_CHAR:
+                            return (Out) *(const unsigned char *) p;
+                        case VALUE_UNSIGNED_SHORT:
+                            return (Out) *(const unsigned short *) p;
+                        case VALUE_UNSIGNED_INT:
+                            return (Out) *(const unsigned int *) p;
+                        case VALUE_UNSIGNED_LONG:
+                            return (Out) *(const unsigned long *) p;
+                        case VALUE_UNSIGNED_LONG_LONG:
+                            return (Out) *(const unsigned long long *) p;
+                        case VALUE_FLOAT:
+                            return (Out) *(const float *) p;
+                        case VALUE_DOUBLE:
+                            return (Out) *(const double *) p;
+                        case VALUE_LONG_DOUBLE:
+                            return (Out) *(const long double *) p;
+                        case VALUE_BOOL:
+                            return (Out) *(const bool *) p;
+                        case VALUE_STRING:
+                            return (Out) std::strtod(((const std::string *) p)->c_str(), nullptr);
+                        default:
+                            return Out(0);
+                    }
+                }
+
+                // Whether a bound unsigned long does not fit the signed 64 bits the drivers send integers as
+                static bool param_exceeds_int64(const bound_param_data &param) {
+                    if (!param.parameter) {
+                        return false;
+                    }
+                    if (param.parameter_tag == VALUE_UNSIGNED_LONG) {
+                        return *(const unsigned long *) param.parameter > (unsigned long long) INT64_MAX;
                     }
+                    if (param.parameter_tag == VALUE_UNSIGNED_LONG_LONG) {
+                        return *(const unsigned long long *) param.parameter > (unsigned long long) INT64_MAX;
+                    }
+                    return false;
                 }
 
-                void string_to_byte(const std::type_index t, void *parameter_address, std::string &data) {
-                    if (t.hash_code() == typeid(char).hash_code()) {
-                        char *address_as_original_type = (char *) parameter_address;
-                        *address_as_original_type = !data.empty() ? data[0] : ' ';
-                    } else if (t.hash_code() == typeid(short int).hash_code()) {
-                        short int *address_as_original_type = (short int *) parameter_address;
-                        *address_as_original_type = (std::stoi(data));
-                    } else if (t.hash_code() == typeid(int).hash_code()) {
-                        int *address_as_original_type = (int *) parameter_address;
-                        *address_as_original_type = (std::stoi(data));
-                    } else if (t.hash_code() == typeid(long int).hash_code()) {
-                        long int *address_as_original_type = (long int *) parameter_address;
-                        *address_as_original_type = (std::stol(data));
-                    } else if (t.hash_code() == typeid(long long int).hash_code()) {
-                        long long int *address_as_original_type = (long long int *) parameter_address;
-                        *address_as_original_type = (std::stoll(data));
-                    } else if (t.hash_code() == typeid(unsigned char).hash_code()) {
-                        unsigned char *address_as_original_type = (unsigned char *) parameter_address;
-                        *address_as_original_type = (!data.empty() ? data[0] : ' ');
-                    } else if (t.hash_code() == typeid(unsigned short int).hash_code()) {
-                        unsigned short int *address_as_original_type = (unsigned short int *) parameter_address;
-                        *address_as_original_type = (std::stoul(data));
-                    } else if (t.hash_code() == typeid(unsigned int).hash_code()) {
-                        unsigned int *address_as_original_type = (unsigned int *) parameter_address;
-                        *address_as_original_type = (std::stoul(data));
-                    } else if (t.hash_code() == typeid(unsigned long int).hash_code()) {
-                        unsigned long int *address_as_original_type = (unsigned long int *) parameter_address;
-                        *address_as_original_type = (std::stoull(data));
-                    } else if (t.hash_code() == typeid(unsigned long long int).hash_code()) {
-                        unsigned long long int *address_as_original_type = (unsigned long long int *) parameter_address;
-                        *address_as_original_type = (std::stoull(data));
-                    } else if (t.hash_code() == typeid(float).hash_code()) {
-                        float *address_as_original_type = (float *) parameter_address;
-                        *address_as_original_type = (std::stof(data));
-                    } else if (t.hash_code() == typeid(double).hash_code()) {
-                        double *address_as_original_type = (double *) parameter_address;
-                        *address_as_original_type = (std::stod(data));
-                    } else if (t.hash_code() == typeid(long double).hash_code()) {
-                        long double *address_as_original_type = (long double *) parameter_address;
-                        *address_as_original_type = (std::stold(data));
-                    } else if (t.hash_code() == typeid(bool).hash_code()) {
-                        bool *address_as_original_type = (bool *) parameter_address;
-                        *address_as_original_type = ((data == "1" || data == "true" || data == "True" || data == "TRUE")
-                                                     ? true : false);
-                    } else if (t.hash_code() == typeid(std::string).hash_code()) {
-                        std::string *address_as_original_type = (std::string *) parameter_address;
-                        *address_as_original_type = std::string(data);
+                std::string byte_to_string(const value_tag t, void *data) {
+                    switch (t) {
+                        case VALUE_CHAR:
+                            return std::to_string(*((char *) data));
+                        case VALUE_SHORT:
+                            return std::to_string(*((short int *) data));
+                        case VALUE_INT:
+                            return std::to_string(*((int *) data));
+                        case VALUE_LONG:
+                            return std::to_string(*((long int *) data));
+                        case VALUE_LONG_LONG:
+                            return std::to_string(*((long long int *) data));
+                        case VALUE_UNSIGNED_CHAR:
+                            return std::to_string(*((unsigned char *) data));
+                        case VALUE_UNSIGNED_SHORT:
+                            return std::to_string(*((unsigned short int *) data));
+                        case VALUE_UNSIGNED_INT:
+                            return std::to_string(*((unsigned int *) data));
+                        case VALUE_UNSIGNED_LONG:
+                            return std::to_string(*((unsigned long int *) data));
+                        case VALUE_UNSIGNED_LONG_LONG:
+                            return std::to_string(*((unsigned long long int *) data));
+                        case VALUE_FLOAT:
+                            return std::to_string(*((float *) data));
+                        case VALUE_DOUBLE:
+                            return std::to_string(*((double *) data));
+                        case VALUE_LONG_DOUBLE:
+                            return std::to_string(*((long double *) data));
+                        case VALUE_BOOL:
+                            return std::to_string(*((bool *) data));
+                        case VALUE_STRING:
+                            return *((std::string *) data);
+                        default:
+                            return "";
+                    }
+                }
+
+                // Stores a fetched cell into a bound column, converting only when the types differ
+                void view_to_byte(const value_tag t, void *parameter_address, const field_view &value) {
+                    switch (t) {
+                        case VALUE_CHAR:
+                            *(char *) parameter_address = !value.empty() ? value.data()[0] : ' ';
+                            break;
+                        case VALUE_SHORT:
+                            *(short int *) parameter_address = (short int) value.get_int();
+                            break;
+                        case VALUE_INT:
+                            *(int *) parameter_address = (int) value.get_int();
+                            break;
+                        case VALUE_LONG:
+                            *(long int *) parameter_address = (long int) value.get_int();
+                            break;
+                        case VALUE_LONG_LONG:
+                            *(long long int *) parameter_address = (long long int) value.get_int();
+                            break;
+                        case VALUE_UNSIGNED_CHAR:
+                            *(unsigned char *) parameter_address = !value.empty() ? value.data()[0] : ' ';
+                            break;
+                        case VALUE_UNSIGNED_SHORT:
+                            *(unsigned short int *) parameter_address = (unsigned short int) value.get_int();
+                            break;
+                        case VALUE_UNSIGNED_INT:
+                            *(unsigned int *) parameter_address = (unsigned int) value.get_int();
+                            break;
+                        case VALUE_UNSIGNED_LONG:
+                            *(unsigned long int *) parameter_address = (unsigned long int) value.get_uint();
+                            break;
+                        case VALUE_UNSIGNED_LONG_LONG:
+                            *(unsigned long long int *) parameter_address = (unsigned long long int) value.get_uint();
+                            break;
+                        case VALUE_FLOAT:
+                            *(float *) parameter_address = (float) value.get_real();
+                            break;
+                        case VALUE_DOUBLE:
+                            *(double *) parameter_address = value.get_real();
+                            break;
+                        case VALUE_LONG_DOUBLE:
+                            *(long double *) parameter_address = value.get_real();
+                            break;
+                        case VALUE_BOOL:
+                            *(bool *) parameter_address = value.get_bool();
+                            break;
+                        case VALUE_STRING:
+                            decode_field(value, *(std::string *) parameter_address);
+                            break;
+                        default:;
                     }
                 }
 
@@ -602,35 +1313,23 @@ namespace wpp {
 
                 template<typename T>
                 constexpr param_type data_object_param_type() {
-                    const size_t t = typeid(T).hash_code();
-                    if (is_integer_hash(t)) {
-                        return param_type::PARAM_INT;
-                    } else if (is_floating_hash(t)) {
-                        return param_type::PARAM_FLOAT;
-                    } else if (is_bool_hash(t)) {
-                        return param_type::PARAM_BOOL;
-                    } else if (is_nullptr_hash(t)) {
-                        return param_type::PARAM_NULL;
-                    } else {
-                        return param_type::PARAM_STR;
-                    }
+                    return param_type_of(value_tag_of<T>::value);
                 }
 
-                bool is_integer_type(const std::type_index t) {
-                    return is_integer_hash(t.hash_code());
+                bool is_integer_type(const value_tag t) {
+                    return is_integer_tag(t);
                 }
 
-                bool is_floating_type(const std::type_index t) {
-                    return is_floating_hash(t.hash_code());
+                bool is_floating_type(const value_tag t) {
+                    return is_floating_tag(t);
                 }
 
-                bool is_bool_type(const std::type_index t) {
-                    return is_bool_hash(t.hash_code());
+                bool is_bool_type(const value_tag t) {
+                    return t == VALUE_BOOL;
                 }
 
-                bool is_string_type(const std::type_index t) {
-                    return !is_integer_hash(t.hash_code()) && !is_floating_hash(t.hash_code()) &&
-                           !is_bool_hash(t.hash_code());
+                bool is_string_type(const value_tag t) {
+                    return !is_integer_tag(t) && !is_floating_tag(t) && t != VALUE_BOOL;
                 }
 
             protected:
@@ -646,7 +1345,18 @@ namespace wpp {
                 // state
                 bool _executed = false;
                 std::vector<column_data> _columns;
-                long _row_count;
+                std::shared_ptr<const row_schema> _schema;
+                std::vector<field_view> _view_fields;
+                std::vector<std::string> _view_buffers;
+                // column positions of the last mapped type, resolved once per schema
+                const void *_mapping_type{nullptr};
+                std::shared_ptr<const row_schema> _mapping_schema;
+                std::vector<size_t> _mapping_positions;
+                long _row_count{0};
+                // values the attributes changed with set_attribute had after prepare
+                std::unordered_map<long, driver_option> _prepared_attributes;
+                // an attribute was changed whose value after prepare the driver couldn't tell
+                bool _unrestorable_attributes{false};
                 std::string _query_string;
                 std::string _active_query_string;
                 std::string _named_rewrite_template;
@@ -658,6 +1368,201 @@ namespace wpp {
                 data_object *_dbh;
         };
 
+        ///////////////////////////////////////////////////////////////
+        //                      STATEMENT CACHE                      //
+        ///////////////////////////////////////////////////////////////
+        // Prepared statements of a connection, least recently used evicted first. A statement is only
+        // handed out again once nobody else holds it. Copies start empty: the statements belong to the
+        // connection that prepared them
+        class statement_cache {
+            public:
+                statement_cache() = default;
+
+                statement_cache(const statement_cache &other) : _capacity(other._capacity) {}
+
+                statement_cache &operator=(const statement_cache &other) {
+                    if (this != &other) {
+                        this->clear();
+                        this->_capacity = other._capacity;
+                    }
+                    return *this;
+                }
+
+                // The SQL text and the prepare options that change how it is prepared
+                static std::string key(const std::string &sql,
+                                       const std::unordered_map<attribute_type, driver_option> &options) {
+                    std::vector<std::pair<int, std::string>> sorted;
+                    for (auto &&option : options) {
+                        sorted.emplace_back((int) option.first, option.second.get_string());
+                    }
+                    std::sort(sorted.begin(), sorted.end());
+                    std::string k;
+                    for (auto &&option : sorted) {
+                        k += std::to_string(option.first) + "=" + option.second + '\0';
+                    }
+                    return k + sql;
+                }
+
+                std::shared_ptr<data_object_statement> take(const std::string &key) {
+                    auto iter = _index.find(key);
+                    if (iter == _index.end() || iter->second->second.use_count() > 1) {
+                        ++_misses;
+                        return nullptr;
+                    }
+                    _entries.splice(_entries.begin(), _entries, iter->second);
+                    ++_hits;
+                    return iter->second->second;
+                }
+
+                void put(const std::string &key, std::shared_ptr<data_object_statement> stmt) {
+                    if (_capacity == 0) {
+                        return;
+                    }
+                    auto iter = _index.find(key);
+                    if (iter != _index.end()) {
+                        _entries.erase(iter->second);
+                    }
+                    _entries.emplace_front(key, std::move(stmt));
+                    _index[key] = _entries.begin();
+                    this->shrink();
+                }
+
+                void forget(const std::string &key) {
+                    auto iter = _index.find(key);
+                    if (iter != _index.end()) {
+                        _entries.erase(iter->second);
+                        _index.erase(iter);
+                    }
+                }
+
+                void clear() {
+                    _index.clear();
+                    _entries.clear();
+                }
+
+                size_t capacity() const { return _capacity; }
+
+                void capacity(size_t n) {
+                    _capacity = n;
+                    this->shrink();
+                }
+
+                size_t size() const { return _entries.size(); }
+
+                unsigned long hits() const { return _hits; }
+
+                unsigned long misses() const { return _misses; }
+
+            protected:
+                void shrink() {
+                    while (_entries.size() > _capacity) {
+                        _index.erase(_entries.back().first);
+                        _entries.pop_back();
+                    }
+                }
+
+                size_t _capacity{0};
+                unsigned long _hits{0};
+                unsigned long _misses{0};
+                // most recently used first
+                std::list<std::pair<std::string, std::shared_ptr<data_object_statement>>> _entries;
+                std::unordered_map<std::string, std::list<std::pair<std::string, std::shared_ptr<data_object_statement>>>::iterator> _index;
+        };
+
+        ///////////////////////////////////////////////////////////////
+        //                      LITERAL QUERIES                      //
+        ///////////////////////////////////////////////////////////////
+        // Statement prepared from a SQL_LITERAL. The number of values and the placeholder names
+        // are checked by the compiler
+        template<typename Text>
+        class literal_statement {
+            public:
+                using literal = sql_literal<Text>;
+
+                literal_statement() = default;
+
+                explicit literal_statement(std::shared_ptr<data_object_statement> stmt) : _stmt(std::move(stmt)) {}
+
+                // Bind a named placeholder: bind(SQL_LITERAL(":name"), value)
+                template<typename Name, typename T>
+                bool bind(sql_literal<Name>, const T &value) {
+                    static_assert(literal::parameter_index(Name::value(), Name::size()) >= 0,
+                                  "the query has no placeholder with this name");
+                    return this->_stmt->bind_value(sql_literal<Name>::str(), value);
+                }
+
+                // Bind parameter I, counting from 0 in the order they appear in the query
+                template<size_t I, typename T>
+                bool bind(const T &value) {
+                    static_assert(I < literal::parameter_count(), "the query does not have that many parameters");
+                    return this->bind_parameter(I, value);
+                }
+
+                // Bind one value per parameter, in order, and execute
+                template<typename... Args>
+                bool execute(const Args &... values) {
+                    static_assert(sizeof...(Args) == literal::parameter_count(),
+                                  "wrong number of parameters for the query");
+                    if (!this->bind_all(std::index_sequence_for<Args...>(), values...)) {
+                        return false;
+                    }
+                    return this->_stmt->execute();
+                }
+
+                const std::shared_ptr<data_object_statement> &statement() const noexcept { return this->_stmt; }
+
+                data_object_statement *operator->() const noexcept { return this->_stmt.get(); }
+
+                explicit operator bool() const noexcept { return this->_stmt != nullptr; }
+
+                // What parse_params would find in the query, from the compile-time scan
+                static std::shared_ptr<const parsed_query> parsed() {
+                    std::shared_ptr<parsed_query> p = std::make_shared<parsed_query>();
+                    constexpr typename literal::layout_type layout = literal::layout();
+                    p->query_type = layout.query_type;
+                    for (size_t k = 0; k < layout.count; ++k) {
+                        placeholder ph;
+                        ph.unquoted.assign(literal::text() + layout.position[k], layout.length[k]);
+                        ph.position_in_query = layout.position[k];
+                        ph.bindno = (int) k;
+                        p->placeholders.emplace_back(std::move(ph));
+                    }
+                    return p;
+                }
+
+            protected:
+                template<size_t... I, typename... Args>
+                bool bind_all(std::index_sequence<I...>, const Args &... values) {
+                    bool ok = true;
+                    int expand[] = {0, (ok = ok && this->bind_parameter(I, values), 0)...};
+                    (void) expand;
+                    return ok;
+                }
+
+                template<typename T>
+                bool bind_parameter(size_t i, const T &value) {
+                    if (literal::is_named()) {
+                        return this->_stmt->bind_value(names()[i], value);
+                    }
+                    return this->_stmt->bind_value((int) i + 1, value);
+                }
+
+                // Placeholder name of each parameter
+                static const std::vector<std::string> &names() {
+                    static const std::vector<std::string> n = []() {
+                        constexpr typename literal::layout_type layout = literal::layout();
+                        std::vector<std::string> v(layout.parameters);
+                        for (size_t k = 0; k < layout.count; ++k) {
+                            v[layout.parameter[k]].assign(literal::text() + layout.position[k], layout.length[k]);
+                        }
+                        return v;
+                    }();
+                    return n;
+                }
+
+                std::shared_ptr<data_object_statement> _stmt;
+        };
+
         ///////////////////////////////////////////////////////////////
         //                    DATA OBJECT CLASS                      //
         ///////////////////////////////////////////////////////////////
@@ -669,13 +1574,17 @@ namespace wpp {
                 friend
                 class data_object_crtp;
 
+                template<typename Driver>
+                friend
+                class connection_pool;
+
                 using stmt = std::shared_ptr<wpp::db::data_object_statement>;
                 using statement = std::shared_ptr<wpp::db::data_object_statement>;
 
                 data_object(std::string _data_source = ":memory:",
                             std::string username = "",
                             std::string passwd = "",
-                            std::unordered_map<attribute_type, driver_option> driver_options = {}) {};
+                            std::unordered_map<attribute_type, driver_option> driver_options = {}) : _in_txn(0) {};
 
                 void data_object_factory(std::string _data_source,
                                          std::string username,
@@ -707,6 +1616,12 @@ namespace wpp {
 
                 long exec(std::string query);
 
+                // Same as exec and query + fetch_all, without blocking the caller. The connection must not be
+                // used until the future is ready
+                std::future<long> exec_async(std::string query);
+
+                virtual std::future<wpp::db::result> query_async(std::string query);
+
                 std::string last_insert_id(std::string seqname = "");
 
                 std::string error_code();
@@ -719,6 +1634,23 @@ namespace wpp {
 
                 bool error() { return this->_error_code != "000000"; }
 
+                // Prepare a SQL_LITERAL, whose placeholders were parsed at compile time
+                template<typename Text>
+                literal_statement<Text>
+                prepare(sql_literal<Text> sql, std::unordered_map<attribute_type, driver_option> options = {}) {
+                    static const bool scanned = (parsed_query_cache::shared().insert(
+                            parsed_query_cache::scan_key(sql.str()), literal_statement<Text>::parsed()), true);
+                    (void) scanned;
+                    return literal_statement<Text>(this->prepare(sql.str(), options));
+                }
+
+                // Statements handed out again by prepare() instead of being prepared (see ATTR_STATEMENT_CACHE)
+                unsigned long statement_cache_hits() const { return this->_statement_cache.hits(); }
+
+                unsigned long statement_cache_misses() const { return this->_statement_cache.misses(); }
+
+                void clear_statement_cache() { this->_statement_cache.clear(); }
+
             protected:
                 ///////////////////////////////////////////////////////////////
                 //           FUNCTIONS TO BE DEFINED BY THE DRIVER           //
@@ -854,6 +1786,8 @@ namespace wpp {
                 unsigned _stringify:1;
                 case_conversion _native_case;
                 case_conversion _desired_case;
+                // prepared statements for reuse, empty unless ATTR_STATEMENT_CACHE is set
+                statement_cache _statement_cache;
             public:
                 ///////////////////////////////////////////////////////////////
                 //VIRTUALS FOR THE CRTP (SHOULD NOT BE DEFINED BY THE DRIVER)//
@@ -921,13 +1855,34 @@ namespace wpp {
                         wpp::db::data_object(dsn, username, passwd, options) {
                 };
 
+                using data_object::prepare;
+
                 virtual std::shared_ptr<data_object_statement>
                 prepare(std::string statement,
                         std::unordered_map<attribute_type, driver_option> options = {}) override {
+                    std::string cache_key;
+                    if (this->_statement_cache.capacity()) {
+                        cache_key = statement_cache::key(statement, options);
+                        std::shared_ptr<data_object_statement> cached = this->_statement_cache.take(cache_key);
+                        if (cached) {
+                            if (cached->resetter() && cached->restore_prepared_attributes()) {
+                                cached->_error_code = "000000";
+                                cached->_bound_param.clear();
+                                cached->_bound_columns.clear();
+                                cached->_row_count = 0;
+                                return cached;
+                            }
+                            /* whatever state it is in, it is not the one of a new statement */
+                            this->_statement_cache.forget(cache_key);
+                        }
+                    }
                     std::shared_ptr<derived_statement> stmt(new derived_statement);
                     stmt->_query_string = statement;
                     stmt->_dbh = this;
                     if (this->preparer(statement, stmt, options)) {
+                        if (!cache_key.empty()) {
+                            this->_statement_cache.put(cache_key, stmt);
+                        }
                         return std::dynamic_pointer_cast<data_object_statement>(stmt);
                     }
                     if (this->_error_code != "000000") {
@@ -1000,6 +1955,76 @@ namespace wpp {
             return false;
         }
 
+        template<typename T>
+        const std::vector<size_t> *data_object_statement::mapped_positions() {
+            /* one static per mapped type works as a type key without RTTI */
+            static const char type_key = 0;
+            if (this->_mapping_type == &type_key && this->_mapping_schema == this->_schema) {
+                return &this->_mapping_positions;
+            }
+            if (!this->_schema) {
+                return nullptr;
+            }
+            row_mapper<T>::resolve(*this->_schema, this->_mapping_positions);
+            for (size_t i = 0; i < this->_mapping_positions.size(); ++i) {
+                if (this->_mapping_positions[i] >= this->_schema->size()) {
+                    this->_mapping_type = nullptr;
+                    data_object::raise_impl_error(this->_dbh, this, "HY000",
+                                                  "result has no column for member " + std::to_string(i));
+                    return nullptr;
+                }
+            }
+            this->_mapping_type = &type_key;
+            this->_mapping_schema = this->_schema;
+            return &this->_mapping_positions;
+        }
+
+        template<typename T>
+        bool data_object_statement::fetch_into(T &destination, fetch_orientation orientation, long offset) {
+            this->_error_code = "000000";
+            if (!this->do_fetch_common(orientation, offset, true)) {
+                if (this->_error_code != "000000") {
+                    data_object::handle_error(*this->_dbh, *this);
+                }
+                return false;
+            }
+            const std::vector<size_t> *positions = this->mapped_positions<T>();
+            if (!positions) {
+                if (this->_error_code != "000000") {
+                    data_object::handle_error(*this->_dbh, *this);
+                }
+                return false;
+            }
+            field_view value;
+            row_mapper<T>::decode(destination, *positions, [&](size_t colno) -> const field_view & {
+                if (!this->get_col_view(colno, value)) {
+                    value = field_view();
+                }
+                return value;
+            });
+            return true;
+        }
+
+        template<typename T>
+        T data_object_statement::fetch_into(fetch_orientation orientation, long offset) {
+            T destination{};
+            this->fetch_into(destination, orientation, offset);
+            return destination;
+        }
+
+        template<typename T>
+        std::vector<T> data_object_statement::fetch_all_as() {
+            std::vector<T> return_value;
+            T destination{};
+            if (this->_row_count > 0) {
+                return_value.reserve(this->_row_count);
+            }
+            while (this->fetch_into(destination)) {
+                return_value.push_back(destination);
+            }
+            return return_value;
+        }
+
         std::string data_object_statement::error_string() {
             std::vector<std::string> info = this->error_info();
             std::string return_value = "Error ";
@@ -1085,7 +2110,7 @@ namespace wpp {
                     }
                     param.param_type = param_type::PARAM_STR;
                     param.parameter_data.reset(new std::string(std::move(tmp)));
-                    param.parameter = &param.parameter_data;
+                    param.parameter = param.parameter_data.get();
                     if (!really_register_bound_param(param, 1)) {
                         return false;
                     }
@@ -1148,6 +2173,41 @@ namespace wpp {
             return false;
         }
 
+        bool data_object_statement::execute_batch(const std::vector<batch_column> &columns) {
+            if (!this->_dbh) {
+                return false;
+            }
+            const size_t rows = columns.empty() ? 0 : columns[0].size();
+            for (const batch_column &column : columns) {
+                if (column.size() != rows) {
+                    data_object::raise_impl_error(this->_dbh, this, "HY093", "batch columns have different sizes");
+                    data_object::handle_error(*this->_dbh, *this);
+                    return false;
+                }
+            }
+            this->_error_code = "000000";
+            if (!this->batch_executer(columns, rows)) {
+                if (this->_error_code != "000000") {
+                    data_object::handle_error(*this->_dbh, *this);
+                }
+                return false;
+            }
+            return true;
+        }
+
+        std::future<bool> data_object_statement::execute_async(std::vector<std::pair<std::string, std::string>> input_params) {
+            /* drivers without a reactor run the blocking call on the shared pool, one at a time per connection */
+            return worker_pool::shared().submit(this->_dbh, [this, input_params]() {
+                return this->execute(input_params);
+            });
+        }
+
+        std::future<wpp::db::result> data_object_statement::fetch_all_async() {
+            return worker_pool::shared().submit(this->_dbh, [this]() {
+                return this->fetch_all();
+            });
+        }
+
         wpp::db::row data_object_statement::fetch(fetch_orientation ori, long off) {
             if (!this->_dbh) {
                 return wpp::db::row();
@@ -1162,6 +2222,26 @@ namespace wpp {
             return return_value;
         }
 
+        wpp::db::row_view data_object_statement::fetch_view(fetch_orientation ori, long off) {
+            if (!this->_dbh) {
+                return wpp::db::row_view();
+            }
+            if (!this->do_fetch_common(ori, off, true)) {
+                if (this->_error_code != "000000") {
+                    data_object::handle_error(*this->_dbh, *this);
+                }
+                return wpp::db::row_view();
+            }
+            /* the views are reused from row to row; nothing is allocated after the first fetch */
+            this->_view_fields.resize(this->_columns.size());
+            for (size_t idx = 0; idx < this->_columns.size(); idx++) {
+                if (!this->get_col_view(idx, this->_view_fields[idx])) {
+                    this->_view_fields[idx] = field_view();
+                }
+            }
+            return wpp::db::row_view(this->_view_fields.data(), this->_view_fields.size(), &this->_schema);
+        }
+
         void data_object::handle_error(data_object &dbh, data_object_statement &stmt) {
             dbh._error_code = stmt._error_code;
             if (dbh._error_mode == ERRMODE_SILENT) {
@@ -1246,10 +2326,13 @@ namespace wpp {
             }
             return_value.clear();
             return_value.reserve(this->_columns.size());
+            return_value.set_schema(this->_schema);
+            field_view value;
             for (size_t idx = 0; idx < this->_columns.size(); idx++) {
-                std::unique_ptr<std::string> val;
-                this->fetch_value(val, idx);
-                return_value.push_back(this->_columns[idx].name, *val);
+                if (!this->get_col_view(idx, value)) {
+                    value = field_view();
+                }
+                return_value.push_back(field(value));
             }
             return 1;
         }
@@ -1257,12 +2340,10 @@ namespace wpp {
         void data_object_statement::update_bound_columns() {
             for (std::pair<const std::string, bound_param_data> &bound_column : this->_bound_columns) {
                 bound_param_data &param = bound_column.second;
-                if (param.paramno >= 0) {
-                    std::unique_ptr<std::string> val;
-                    this->fetch_value(val, param.paramno);
-                    if (val) {
-                        string_to_byte(param.parameter_typeinfo, param.parameter, *val);
-                    }
+                field_view value;
+                /* the view reads the driver's buffer in place: no string per cell */
+                if (param.paramno >= 0 && this->get_col_view(param.paramno, value) && !value.is_null()) {
+                    view_to_byte(param.parameter_tag, param.parameter, value);
                 }
             }
         }
@@ -1290,18 +2371,6 @@ namespace wpp {
             return 1;
         }
 
-        inline void data_object_statement::fetch_value(std::unique_ptr<std::string> &dest, int colno) {
-            int caller_frees = 0;
-            column_data &col = this->_columns[colno];
-            std::string value;
-            this->get_col(colno, value, caller_frees);
-            if (!value.empty() && !(value.empty() && this->_dbh->_oracle_nulls == null_handling::NULL_EMPTY_STRING)) {
-                dest.reset(new std::string(std::move(value)));
-            } else {
-                dest.reset(new std::string(""));
-            }
-        }
-
         wpp::db::result data_object_statement::fetch_all() {
             int error = 0;
             wpp::db::row data;
@@ -1313,6 +2382,7 @@ namespace wpp {
                 }
             }
             if (!error) {
+                return_value.set_schema(this->_schema);
                 do {
                     return_value.push_back(data);
                 } while (this->do_fetch(1, data, FETCH_ORI_NEXT, 0));
@@ -1326,6 +2396,48 @@ namespace wpp {
             return return_value;
         }
 
+        wpp::db::columnar_result data_object_statement::fetch_all_columnar() {
+            wpp::db::columnar_result return_value;
+            this->_error_code = "000000";
+            if (!this->do_fetch_common(FETCH_ORI_NEXT, 0, true)) {
+                if (this->_error_code != "000000") {
+                    data_object::handle_error(*this->_dbh, *this);
+                } else if (this->_executed && !this->_columns.empty() && this->describe_columns()) {
+                    /* no rows: every column is still there, with length 0 */
+                    return_value = wpp::db::columnar_result(this->_schema);
+                }
+                return return_value;
+            }
+            return_value = wpp::db::columnar_result(this->_schema);
+            for (size_t idx = 0; idx < return_value.columns() && this->_row_count > 0; idx++) {
+                return_value.get_column(idx).reserve(this->_row_count);
+            }
+            /* typed views straight from the driver buffers: numbers are never formatted and parsed back */
+            field_view value;
+            do {
+                for (size_t idx = 0; idx < this->_columns.size(); idx++) {
+                    if (!this->get_col_view(idx, value)) {
+                        value = field_view();
+                    }
+                    return_value.get_column(idx).push_back(value);
+                }
+            } while (this->do_fetch_common(FETCH_ORI_NEXT, 0, true));
+            return return_value;
+        }
+
+        data_type data_object_statement::column_data_type(param_type type) {
+            switch (type) {
+                case PARAM_INT:
+                    return INTEGER;
+                case PARAM_FLOAT:
+                    return REAL;
+                case PARAM_BOOL:
+                    return BOOLEAN;
+                default:
+                    return STRING;
+            }
+        }
+
         void data_object_statement::map_the_name_to_column(bound_param_data &param) {
             for (int i = 0; i < this->_columns.size(); i++) {
                 if (this->_columns[i].name == param.name) {
@@ -1343,7 +2455,7 @@ namespace wpp {
         int data_object_statement::really_register_bound_param(bound_param_data &param, int is_param) {
             const bool is_column = !is_param;
             const bool parameter_pointer_is_valid = param.parameter != nullptr;
-            const bool parameter_points_to_internal_data = param.parameter != (void *) (&param.parameter_data);
+            const bool parameter_points_to_internal_data = param.parameter == (void *) param.parameter_data.get();
             const bool param_is_reference = parameter_pointer_is_valid && !parameter_points_to_internal_data;
             param.stmt = this;
             param.is_param = is_param;
@@ -1369,12 +2481,16 @@ namespace wpp {
                 hash->erase(std::to_string(param.paramno));
             }
             /* allocate storage for the parameter, keyed by its "canonical" name */
-            std::unordered_map<std::string, bound_param_data>::iterator pparam;
-            if (!param.name.empty()) {
-                pparam = hash->emplace(std::make_pair(param.name, std::move(param))).first;
-            } else {
-                pparam = hash->emplace(std::make_pair(std::to_string(param.paramno), std::move(param))).first;
+            const std::string key = !param.name.empty() ? param.name : std::to_string(param.paramno);
+            /* binding the same name again replaces the value */
+            auto previous = hash->find(key);
+            if (previous != hash->end()) {
+                this->param_hook(previous->second, PARAM_EVT_FREE);
+                hash->erase(previous);
             }
+            std::unordered_map<std::string, bound_param_data>::iterator pparam =
+                    hash->emplace(std::make_pair(key, std::move(param))).first;
+            pparam->second.point_to_native();
             /* tell the driver we just created a parameter */
             if (!this->param_hook(pparam->second, PARAM_EVT_ALLOC)) {
                 /* undo storage allocation; the hash will free the parameter name if required */
@@ -1428,17 +2544,61 @@ namespace wpp {
         }
 
         int data_object_statement::parse_params(std::string &inquery, std::string &outquery) {
+            if (!parsed_query_cache::shared().caches(inquery.size())) {
+                parsed_query parsed;
+                scan_params(inquery, parsed);
+                return this->rewrite_params(inquery, outquery, parsed.query_type, parsed.placeholders);
+            }
+            const std::string key = parsed_query_cache::key(inquery, this->_supports_placeholders,
+                                                            this->_named_rewrite_template);
+            std::shared_ptr<const parsed_query> cached = parsed_query_cache::shared().find(key);
+            if (!cached && this->_supports_placeholders != placeholder_support::PLACEHOLDER_NONE) {
+                /* scanned before, maybe at compile time (SQL_LITERAL), but not rewritten like this */
+                cached = parsed_query_cache::shared().find(parsed_query_cache::scan_key(inquery));
+            }
+            if (cached && cached->ret != -1) {
+                if (cached->ret == 1) {
+                    outquery = cached->outquery;
+                }
+                if (cached->rewrites_param_map) {
+                    this->_bound_param_map = cached->bound_param_map;
+                }
+                return cached->ret;
+            }
+            std::shared_ptr<parsed_query> parsed;
+            if (cached) {
+                parsed = std::make_shared<parsed_query>(*cached);
+                parsed->ret = -1;
+            } else {
+                parsed = std::make_shared<parsed_query>();
+                scan_params(inquery, *parsed);
+            }
+            /* the rewrite reuses the scanned placeholders to hold the replacements */
+            std::vector<placeholder> placeholders = parsed->placeholders;
+            const int ret = this->rewrite_params(inquery, outquery, parsed->query_type, placeholders);
+            /* without native placeholders the rewrite quotes the bound values, so only the scan is kept */
+            if (ret != -1 && this->_supports_placeholders != placeholder_support::PLACEHOLDER_NONE) {
+                parsed->ret = ret;
+                if (ret == 1) {
+                    parsed->outquery = outquery;
+                }
+                /* only the rewrite from ? to $n maps the parameters */
+                parsed->rewrites_param_map = ret == 1 && (parsed->query_type == PLACEHOLDER_POSITIONAL ||
+                                                          !this->_named_rewrite_template.empty());
+                if (parsed->rewrites_param_map) {
+                    parsed->bound_param_map = this->_bound_param_map;
+                }
+            }
+            if (!cached || parsed->ret != -1) {
+                parsed_query_cache::shared().insert(key, parsed);
+            }
+            return ret;
+        }
+
+        void data_object_statement::scan_params(std::string &inquery, parsed_query &parsed) {
             scanner s;
-            size_t ptr = 0;
-            size_t output_len;
             int t;
             uint32_t bindno = 0;
-            int ret = 0;
-            std::unordered_map<std::string, bound_param_data> params;
-            std::unique_ptr<bound_param_data> param;
-            int query_type = placeholder_support::PLACEHOLDER_NONE;
-            std::vector<placeholder> placeholders;
-            size_t plc;
             s.cur = &inquery[0u];
             s.end = &inquery[0u] + inquery.length() + 1;
             /* phase 1: look for args */
@@ -1446,21 +2606,31 @@ namespace wpp {
                 if (t == PARSER_BIND || t == PARSER_BIND_POS) {
                     if (t == PARSER_BIND) {
                         int len = s.cur - s.tok;
-                        if ((inquery < (s.cur - len)) && isalnum(*(s.cur - len - 1))) {
+                        if ((s.tok > &inquery[0u]) && isalnum(*(s.cur - len - 1))) {
                             continue;
                         }
-                        query_type |= PLACEHOLDER_NAMED;
+                        parsed.query_type |= PLACEHOLDER_NAMED;
                     } else {
-                        query_type |= PLACEHOLDER_POSITIONAL;
+                        parsed.query_type |= PLACEHOLDER_POSITIONAL;
                     }
                     placeholder p;
                     p.unquoted.resize(s.cur - s.tok);
                     std::copy(s.tok, s.cur, p.unquoted.begin());
                     p.position_in_query = s.cur - &inquery[0u] - p.unquoted.size();
                     p.bindno = bindno++;
-                    placeholders.emplace_back(std::move(p));
+                    parsed.placeholders.emplace_back(std::move(p));
                 }
             }
+        }
+
+        int data_object_statement::rewrite_params(std::string &inquery, std::string &outquery, int query_type,
+                                                  std::vector<placeholder> &placeholders) {
+            size_t ptr = 0;
+            int t;
+            const uint32_t bindno = placeholders.size();
+            int ret = 0;
+            std::unique_ptr<bound_param_data> param;
+            size_t plc;
             if (bindno == 0) {
                 /* nothing to do; good! */
                 return 0;
@@ -1535,14 +2705,14 @@ namespace wpp {
                     } else {
                         param_iter = this->_bound_param.find(std::string(placeholders[plc].unquoted));
                     }
-                    if (param_iter != this->_bound_param.end()) {
+                    if (param_iter == this->_bound_param.end()) {
                         ret = -1;
                         data_object::raise_impl_error(this->_dbh, this, "HY093", "parameter was not defined");
                         return ret;
                     }
                     void *parameter = param_iter->second.parameter;
-                    std::type_index parameter_type_index = param_iter->second.parameter_typeinfo;
-                    enum param_type param_type = param->param_type;
+                    value_tag parameter_type_index = param_iter->second.parameter_tag;
+                    enum param_type param_type = param_iter->second.param_type;
                     std::string buf;
                     /* assume all types are nullable */
                     if (!parameter) {
@@ -1558,7 +2728,7 @@ namespace wpp {
                             placeholders[plc].freeq = 1;
                             break;
                         case PARAM_NULL:
-                            placeholders[plc].quoted = "nullptr";
+                            placeholders[plc].quoted = "NULL";
                             placeholders[plc].freeq = 0;
                             break;
                         default:
@@ -1598,7 +2768,6 @@ namespace wpp {
                 std::string idxbuf;
                 std::string tmpl = !this->_named_rewrite_template.empty() ? this->_named_rewrite_template : ":pdo%d";
                 int bind_no = 1;
-                output_len = inquery.size();
                 this->_bound_param_map.clear();
                 for (plc = 0; plc < placeholders.size(); ++plc) {
                     int skip_map = 0;
@@ -1648,13 +2817,15 @@ namespace wpp {
                 }
                 return wpp::db::field();
             }
-            std::unique_ptr<std::string> return_value;
-            this->fetch_value(return_value, column_number);
-            if (return_value) {
-                return *return_value;
-            } else {
+            field_view value;
+            if (!this->get_col_view(column_number, value)) {
                 return wpp::db::field();
             }
+            return wpp::db::field(value);
+        }
+
+        wpp::db::field data_object_statement::fetch_column(column_handle &column) {
+            return this->fetch_column((long) column.column_number(this->_schema));
         }
 
         const std::string data_object_statement::sqlstate_state_to_description(std::string state) {
@@ -1948,11 +3119,59 @@ namespace wpp {
             return 0;
         }
 
+        int data_object_statement::batch_executer(const std::vector<batch_column> &columns, size_t rows) {
+            /* drivers without a bulk path bind and execute row by row */
+            long changes = 0;
+            for (size_t row = 0; row < rows; ++row) {
+                for (size_t col = 0; col < columns.size(); ++col) {
+                    switch (columns[col].type()) {
+                        case PARAM_INT:
+                            this->bind_value(col + 1, (long) columns[col].get_int(row));
+                            break;
+                        case PARAM_FLOAT:
+                            this->bind_value(col + 1, columns[col].get_real(row));
+                            break;
+                        default:
+                            this->bind_value(col + 1, columns[col].get_string(row));
+                    }
+                }
+                if (!this->execute()) {
+                    return 0;
+                }
+                changes += this->_row_count;
+            }
+            this->_row_count = changes;
+            return 1;
+        }
+
         int data_object_statement::get_col(int colno, std::string &ptr, int &caller_frees) {
             data_object::raise_impl_error(this->_dbh, nullptr, "IM001", "driver does not implement get_col");
             return 0;
         }
 
+        int data_object_statement::col_is_null(int colno) {
+            return 0;
+        }
+
+        int data_object_statement::get_col_view(int colno, field_view &value) {
+            /* drivers without direct buffer access go through get_col and a scratch string per column */
+            int caller_frees = 0;
+            if (this->_view_buffers.size() < this->_columns.size()) {
+                this->_view_buffers.resize(this->_columns.size());
+            }
+            std::string &buffer = this->_view_buffers[colno];
+            buffer.clear();
+            if (!this->get_col(colno, buffer, caller_frees)) {
+                return 0;
+            }
+            if (this->col_is_null(colno)) {
+                value = field_view();
+            } else {
+                value = field_view(buffer.data(), buffer.size());
+            }
+            return 1;
+        }
+
         int data_object_statement::param_hook(bound_param_data &attr, param_event val) {
             return 0;
         }
@@ -2002,6 +3221,12 @@ namespace wpp {
                     }
                 }
             }
+            /* build the column header once; every fetched row shares it */
+            std::shared_ptr<row_schema> schema = std::make_shared<row_schema>();
+            for (column_data &column : this->_columns) {
+                schema->push_back(column.name, column_data_type(column.param_type));
+            }
+            this->_schema = schema;
             return 1;
         }
 
@@ -2169,6 +3394,7 @@ namespace wpp {
                 }
                 yy12:
                 ++cursor;
+                cursor = scan_text_run(cursor, s->end);
                 if (s->end <= cursor) {
                     s->cur = cursor;
                     return 4;
@@ -2202,8 +3428,8 @@ namespace wpp {
                 yy15:
                 ++cursor;
                 if (s->end <= cursor) {
-                    s->cur = cursor;
-                    return 4;
+                    /* unterminated comment: like an unterminated quote, the slash alone is text */
+                    goto yy4;
                 }
                 yych = *cursor;
                 switch (yych) {
@@ -2215,8 +3441,8 @@ namespace wpp {
                 yy17:
                 ++cursor;
                 if (s->end <= cursor) {
-                    s->cur = cursor;
-                    return 4;
+                    /* unterminated comment: like an unterminated quote, the slash alone is text */
+                    goto yy4;
                 }
                 yych = *cursor;
                 switch (yych) {
@@ -2367,6 +3593,7 @@ namespace wpp {
                 }
                 yy31:
                 ++cursor;
+                cursor = scan_single_quoted(cursor, s->end);
                 if (s->end <= cursor) {
                     s->cur = cursor;
                     return 4;
@@ -2404,6 +3631,7 @@ namespace wpp {
                 }
                 yy36:
                 ++cursor;
+                cursor = scan_double_quoted(cursor, s->end);
                 if (s->end <= cursor) {
                     s->cur = cursor;
                     return 4;
@@ -2466,8 +3694,17 @@ namespace wpp {
         }
 
         bool data_object_statement::set_attribute(long attribute, driver_option value) {
+            /* the first change of an attribute records its value from prepare, which the cache puts back */
+            const bool first_change = !this->_prepared_attributes.count(attribute);
+            driver_option prepared;
+            const bool known = first_change && this->peek_attribute(attribute, prepared);
             this->_error_code = "000000";
             if (this->set_attribute_func(attribute, value)) {
+                if (known) {
+                    this->_prepared_attributes.emplace(attribute, prepared);
+                } else if (first_change) {
+                    this->_unrestorable_attributes = true;
+                }
                 return true;
             } else {
                 if (this->_error_code != "000000") {
@@ -2492,6 +3729,10 @@ namespace wpp {
             return generic_stmt_attr_get(return_value, attr);
         }
 
+        int data_object_statement::peek_attribute(long attr, driver_option &val) {
+            return this->generic_stmt_attr_get(val, (attribute_type) attr);
+        }
+
         int data_object_statement::get_attribute(long attr, driver_option &val) {
             driver_option return_value;
             if (!this->generic_stmt_attr_get(return_value, (attribute_type) attr)) {
@@ -2589,6 +3830,24 @@ namespace wpp {
             return true;
         }
 
+        int data_object_statement::resetter() {
+            return this->cursor_closer();
+        }
+
+        int data_object_statement::restore_prepared_attributes() {
+            /* the cache prepares a new statement instead */
+            if (this->_unrestorable_attributes) {
+                return 0;
+            }
+            for (std::pair<const long, driver_option> &attribute : this->_prepared_attributes) {
+                if (!this->set_attribute_func(attribute.first, attribute.second)) {
+                    return 0;
+                }
+            }
+            this->_prepared_attributes.clear();
+            return 1;
+        }
+
         bool data_object_statement::close_cursor() {
             if (!this->_dbh) {
                 return false;
@@ -2639,13 +3898,10 @@ namespace wpp {
                     std::unordered_map<std::string, data_object *>::iterator it = persistent_list.find(hashkey);
                     if (it != persistent_list.end()) {
                         pdbh = it->second;
-                        const bool connection_is_alive = !pdbh || (pdbh && !pdbh->check_liveness());
-                        if (connection_is_alive) {
-                            if (pdbh) {
-                                pdbh->_refcount--;
-                            } else {
-                                persistent_list.erase(it);
-                            }
+                        /* a dead handle is forgotten and a new one is opened in its place */
+                        if (!pdbh || !pdbh->check_liveness()) {
+                            persistent_list.erase(it);
+                            pdbh = nullptr;
                         }
                     }
                     if (pdbh) {
@@ -2676,6 +3932,10 @@ namespace wpp {
             } else {
                 this->_auto_commit = iter->second.get_int();
             }
+            iter = options.find(ATTR_STATEMENT_CACHE);
+            if (iter != options.end()) {
+                this->_statement_cache.capacity((size_t) std::max(0, iter->second.get_int()));
+            }
             if (this->_data_source.empty()) {
                 throw std::runtime_error("Improper dns data source");
             }
@@ -2832,14 +4092,19 @@ namespace wpp {
                 this->_stringify = on_off.get_int();
                 return true;
             }
-            return false;
+            if (value == ATTR_STATEMENT_CACHE) {
+                this->_statement_cache.capacity((size_t) std::max(0, on_off.get_int()));
+                return true;
+            }
+            /* driver attributes, such as the pragmas of sqlite */
+            return this->set_attribute_func(value, on_off);
         }
 
         driver_option data_object::get_attribute(attribute_type attribute) {
             driver_option o;
             switch (attribute) {
                 case ATTR_PERSISTENT:
-                    return driver_option(this->_is_persistent);
+                    return driver_option((int) this->_is_persistent);
                 case ATTR_CASE:
                     return driver_option(this->_desired_case);
                 case ATTR_ORACLE_NULLS:
@@ -2847,7 +4112,9 @@ namespace wpp {
                 case ATTR_ERRMODE:
                     return driver_option(this->_error_mode);
                 case ATTR_AUTOCOMMIT:
-                    return driver_option(this->_auto_commit);
+                    return driver_option((int) this->_auto_commit);
+                case ATTR_STATEMENT_CACHE:
+                    return driver_option((int) this->_statement_cache.capacity());
                 default:
                     break;
             }
@@ -2862,9 +4129,21 @@ namespace wpp {
                     data_object::raise_impl_error(this, nullptr, "IM001", "driver does not support that attribute");
                     return false;
                 default:
-                    return false;
+                    return return_value;
             }
-            return false;
+        }
+
+        std::future<long> data_object::exec_async(std::string query) {
+            return worker_pool::shared().submit(this, [this, query]() {
+                return this->exec(query);
+            });
+        }
+
+        std::future<wpp::db::result> data_object::query_async(std::string query) {
+            return worker_pool::shared().submit(this, [this, query]() {
+                statement stmt = this->query(query);
+                return stmt ? stmt->fetch_all() : wpp::db::result();
+            });
         }
 
         long data_object::exec(std::string query) {
@@ -5,6 +5,16 @@
 #define WPP_PGSQL_DRIVER_H
 
 #include <stdlib.h>
+#include <cinttypes>
+#include <cstring>
+#include <limits>
+#include <functional>
+#include <future>
+#ifdef __linux__
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#endif
 #include <libpq-fe.h>
 #include <libpq/libpq-fs.h>
 #include "pg_config.h" /* needed for PG_VERSION */
@@ -17,8 +27,16 @@ namespace wpp {
         ///////////////////////////////////////////////////////////////
         class pgsql_data_object;
 
+        class pgsql_pipeline;
+
         enum pgsql_attribute_type {
             PGSQL_ATTR_DISABLE_PREPARES = attribute_type::ATTR_DRIVER_SPECIFIC,
+            // rows per result while streaming: 0 buffers the whole result, 1 is single row mode
+            PGSQL_ATTR_STREAMING,
+        };
+        enum copy_format {
+            COPY_TEXT,
+            COPY_BINARY
         };
         struct pgsql_column {
             std::string def;
@@ -38,20 +56,35 @@ namespace wpp {
             public:
                 friend pgsql_data_object;
 
+                friend pgsql_pipeline;
+
                 ~pgsql_statement();
 
                 virtual int executer() override;
 
+                virtual int batch_executer(const std::vector<batch_column> &columns, size_t rows) override;
+
+                virtual std::future<bool>
+                execute_async(std::vector<std::pair<std::string, std::string>> input_parameters = {}) override;
+
                 virtual int fetcher(fetch_orientation ori, long offset) override;
 
                 virtual int describer(int colno) override;
 
                 virtual int get_col(int colno, std::string &ptr, int &caller_frees) override;
 
+                virtual int col_is_null(int colno) override;
+
+                virtual int get_col_view(int colno, field_view &value) override;
+
                 virtual int param_hook(bound_param_data &attr, param_event val) override;
 
-                //virtual int set_attribute(long attr, std::string &val) override;
-                //virtual int get_attribute(long attr, std::string &val) override;
+                virtual int set_attribute_func(long attr, driver_option &val) override;
+
+                virtual int get_attribute(long attr, driver_option &val) override;
+
+                virtual int peek_attribute(long attr, driver_option &val) override;
+
                 virtual int get_column_meta(long colno, column_data &return_value) override;
 
                 //virtual int next_rowset_func() override;
@@ -66,9 +99,14 @@ namespace wpp {
                 std::string _query;
                 std::vector<std::string> _param_values;
                 // Useful format for posgresql
+                std::vector<const char *> _param_pointers;
                 std::vector<int> _param_lengths;
                 std::vector<int> _param_formats;
                 std::vector<Oid> _param_types;
+                // Integers, reals and booleans encoded in place: no allocation per execution
+                std::vector<std::array<char, 32>> _param_buffers;
+                // Parameter types the server inferred for the prepared statement (empty if not described)
+                std::vector<Oid> _param_server_types;
                 int _current_row;
                 bool _is_prepared{false};
                 // Connection
@@ -78,21 +116,58 @@ namespace wpp {
                 PGresult *_result{nullptr};
                 // PGSQL columns
                 std::vector<pgsql_column> _cols;
+                // Scrollable cursors: rows per FETCH, the local block and where the client and server are
+                long _prefetch{1};
+                long _block_start{1};
+                long _position{0};
+                long _server_position{0};
+                long _cursor_rows{-1};
+                // Streaming: rows per result (0 is off) and whether results are still coming
+                int _streaming{0};
+                bool _stream_active{false};
 
                 int get_cursor_result();
 
                 int prepare();
 
+                int describe_prepared();
+
+                int encode_param(bound_param_data &param);
+
                 int execute_prepared();
 
                 int execute_with_param();
 
                 int execute_plain_query();
 
+                int send_query();
+
+                int next_stream_result();
+
+                int fetch_cursor_block(long target);
+
+                long cursor_row_count();
+
+                void drain_stream();
+
+                int send_execution(std::vector<std::pair<std::string, std::string>> &input_params, bool pipelined,
+                                   bool &sent_prepare);
+
+                int start_async(std::vector<std::pair<std::string, std::string>> &input_params,
+                                std::function<void(bool)> done);
+
+                template<typename T>
+                void reject(std::promise<T> &promise, T value);
+
+                int receive_pipelined(PGresult *res);
+
                 int check_status(ExecStatusType &status);
 
                 int update_row_and_column_count(ExecStatusType status);
 
+                static void batch_row_values(const std::vector<batch_column> &columns, size_t row,
+                                             std::vector<std::string> &text, std::vector<const char *> &values);
+
             public:
                 const std::string BOOLLABEL = "bool";
                 const std::string BYTEALABEL = "bytea";
@@ -109,17 +184,254 @@ namespace wpp {
                 const static Oid INT2OID = 21;
                 const static Oid INT4OID = 23;
                 const static Oid INT8OID = 20;
+                const static Oid FLOAT4OID = 700;
+                const static Oid FLOAT8OID = 701;
                 const static Oid OIDOID = 26;
                 const static Oid TEXTOID = 25;
                 const static Oid TIMESTAMPOID = 1114;
                 const static Oid VARCHAROID = 1043;
         };
 
+        // Rows streamed into a table with COPY ... FROM STDIN
+        class pgsql_copy_writer {
+            public:
+                friend pgsql_data_object;
+
+                pgsql_copy_writer() = default;
+
+                pgsql_copy_writer(const pgsql_copy_writer &) = delete;
+
+                pgsql_copy_writer(pgsql_copy_writer &&other) noexcept { *this = std::move(other); }
+
+                pgsql_copy_writer &operator=(pgsql_copy_writer &&other) noexcept {
+                    std::swap(_dbh, other._dbh);
+                    std::swap(_format, other._format);
+                    std::swap(_buffer, other._buffer);
+                    return *this;
+                }
+
+                // Unfinished copies are aborted, so nothing is committed
+                ~pgsql_copy_writer() {
+                    if (this->_dbh) {
+                        this->abort();
+                    }
+                }
+
+                explicit operator bool() const noexcept { return this->_dbh != nullptr; }
+
+                template<typename... Ts>
+                bool write_row(const Ts &... values);
+
+                template<typename... Ts>
+                bool write_row(const std::tuple<Ts...> &values);
+
+                // One row per element; every column must have the same size
+                bool write_columns(const std::vector<batch_column> &columns);
+
+                bool write_columns(const columnar_result &columns);
+
+                // Finish the copy; returns the number of rows copied or -1
+                long end();
+
+                bool abort(const std::string &reason = "COPY aborted by the client");
+
+            protected:
+                pgsql_copy_writer(pgsql_data_object *dbh, copy_format format);
+
+                template<size_t... I, typename... Ts>
+                bool write_tuple(const std::tuple<Ts...> &values, std::index_sequence<I...>);
+
+                void begin_row(size_t fields);
+
+                bool end_row();
+
+                void separator();
+
+                void put(std::nullptr_t);
+
+                void put(bool value);
+
+                template<typename T>
+                typename std::enable_if<is_pure_int<T>::value>::type put(T value) { this->put_int((int64_t) value); }
+
+                template<typename T>
+                typename std::enable_if<std::is_floating_point<T>::value>::type put(T value) {
+                    this->put_real((double) value);
+                }
+
+                void put(const char *value) { this->put_text(value, std::strlen(value)); }
+
+                void put(const std::string &value) { this->put_text(value.data(), value.size()); }
+
+                void put(boost::string_view value) { this->put_text(value.data(), value.size()); }
+
+                void put_int(int64_t value);
+
+                void put_real(double value);
+
+                void put_text(const char *data, size_t size);
+
+                void put_uint(uint64_t value, int bytes);
+
+                bool flush(bool force);
+
+                bool fail();
+
+                // bytes buffered before handing a chunk to libpq
+                static constexpr size_t chunk_size = 64 * 1024;
+
+                pgsql_data_object *_dbh{nullptr};
+                copy_format _format{COPY_TEXT};
+                std::string _buffer;
+                bool _first_field{true};
+        };
+
+        #ifdef __linux__
+        // One thread waiting on the sockets of every connection with a query in flight
+        class pgsql_reactor {
+            public:
+                ~pgsql_reactor();
+
+                static pgsql_reactor &shared() {
+                    static pgsql_reactor reactor;
+                    return reactor;
+                }
+
+                // Call on_done with the last result of conn (null if the connection failed), in the reactor thread
+                bool watch(PGconn *conn, std::function<void(PGresult *)> on_done);
+
+            protected:
+                struct operation {
+                    PGconn *conn;
+                    std::function<void(PGresult *)> on_done;
+                    PGresult *last;
+                };
+
+                pgsql_reactor();
+
+                void run();
+
+                // false when the operation is over
+                bool on_event(operation &op, uint32_t events);
+
+                int _epoll;
+                int _wakeup;
+                std::mutex _mutex;
+                std::unordered_map<int, operation> _operations;
+                std::thread _thread;
+        };
+        #endif
+
+        // Statement executions queued on one connection and sent without waiting for each other.
+        // Results come back in sync(), which also runs when the pipeline is destroyed
+        class pgsql_pipeline {
+            public:
+                friend pgsql_data_object;
+
+                pgsql_pipeline() = default;
+
+                pgsql_pipeline(const pgsql_pipeline &) = delete;
+
+                pgsql_pipeline(pgsql_pipeline &&other) noexcept { *this = std::move(other); }
+
+                pgsql_pipeline &operator=(pgsql_pipeline &&other) noexcept {
+                    std::swap(_dbh, other._dbh);
+                    std::swap(_pending, other._pending);
+                    return *this;
+                }
+
+                ~pgsql_pipeline();
+
+                explicit operator bool() const noexcept { return this->_dbh != nullptr; }
+
+                // Queue an execution with the parameters bound now. The future is true once the results
+                // are in the statement, false (or the exception of ERRMODE_EXCEPTION) if it failed
+                std::future<bool> execute(const std::shared_ptr<data_object_statement> &stmt,
+                                          std::vector<std::pair<std::string, std::string>> input_parameters = {});
+
+                // Send everything queued and collect the results; false if any execution failed
+                bool sync();
+
+                size_t pending() const noexcept { return this->_pending.size(); }
+
+            protected:
+                struct pending_execution {
+                    std::shared_ptr<pgsql_statement> stmt;
+                    std::promise<bool> promise;
+                    bool sent_prepare;
+                    // false if only the prepare made it into the pipeline; the promise has failed already
+                    bool sent_execution{true};
+                };
+
+                explicit pgsql_pipeline(pgsql_data_object *dbh);
+
+                static void fail(pending_execution &execution);
+
+                pgsql_data_object *_dbh{nullptr};
+                std::vector<pending_execution> _pending;
+        };
+
+        // Rows streamed out of the server with COPY ... TO STDOUT, one chunk in memory at a time
+        class pgsql_copy_reader {
+            public:
+                friend pgsql_data_object;
+
+                pgsql_copy_reader() = default;
+
+                pgsql_copy_reader(const pgsql_copy_reader &) = delete;
+
+                pgsql_copy_reader(pgsql_copy_reader &&other) noexcept { *this = std::move(other); }
+
+                pgsql_copy_reader &operator=(pgsql_copy_reader &&other) noexcept {
+                    std::swap(_dbh, other._dbh);
+                    std::swap(_format, other._format);
+                    std::swap(_chunk, other._chunk);
+                    std::swap(_row_count, other._row_count);
+                    return *this;
+                }
+
+                // Unfinished copies are drained, so the connection can be used again
+                ~pgsql_copy_reader();
+
+                explicit operator bool() const noexcept { return this->_dbh != nullptr; }
+
+                // Next raw chunk from the server (a whole row in text format); valid until the next call
+                bool next(boost::string_view &chunk);
+
+                // Next row parsed from the text format; views are valid until the next call
+                row_view next_row();
+
+                // Rows copied, once the reader is done
+                long row_count() const noexcept { return this->_row_count; }
+
+            protected:
+                pgsql_copy_reader(pgsql_data_object *dbh, copy_format format) : _dbh(dbh), _format(format) {}
+
+                int finish();
+
+                void release_chunk();
+
+                pgsql_data_object *_dbh{nullptr};
+                copy_format _format{COPY_TEXT};
+                char *_chunk{nullptr};
+                long _row_count{-1};
+                // unescaped text and fields of the last parsed row
+                std::string _unescaped;
+                std::vector<field_view> _fields;
+                std::shared_ptr<const row_schema> _schema;
+        };
+
         class pgsql_data_object
                 : public data_object_crtp<pgsql_data_object, pgsql_statement> {
             public:
                 friend class pgsql_statement;
 
+                friend class pgsql_copy_writer;
+
+                friend class pgsql_copy_reader;
+
+                friend class pgsql_pipeline;
+
                 pgsql_data_object(std::string data_source,
                                   std::string username,
                                   std::string passwd,
@@ -161,6 +473,29 @@ namespace wpp {
 
                 virtual int in_transaction_func() override;
 
+                virtual std::future<wpp::db::result> query_async(std::string query) override;
+
+                // Start a COPY into table, which may include a column list as in "employee(name, salary)".
+                // Binary copies need the column types to match: int8, float8, bool and text
+                pgsql_copy_writer copy_in(const std::string &table, copy_format format = COPY_TEXT);
+
+                long copy_in(const std::string &table, const std::vector<batch_column> &columns,
+                             copy_format format = COPY_TEXT);
+
+                template<typename... Ts>
+                long copy_in(const std::string &table, const std::vector<std::tuple<Ts...>> &rows,
+                             copy_format format = COPY_TEXT);
+
+                // Start queueing statement executions; the connection can't be used otherwise until sync()
+                pgsql_pipeline pipeline();
+
+                // Start a COPY out of a table or a parenthesized query, as in "(SELECT name FROM employee)"
+                pgsql_copy_reader copy_out(const std::string &source, copy_format format = COPY_TEXT);
+
+                // Call back with each raw chunk until it returns false; returns the number of rows or -1
+                long copy_out(const std::string &source, std::function<bool(boost::string_view)> callback,
+                              copy_format format = COPY_TEXT);
+
             protected:
                 // Auxiliary functions
                 void clear_result_set();
@@ -219,6 +554,7 @@ namespace wpp {
         //                    STATEMENT DEFINITIONS                  //
         ///////////////////////////////////////////////////////////////
         pgsql_statement::~pgsql_statement() {
+            this->drain_stream();
             if (this->_result) {
                 PQclear(this->_result);
                 this->_result = (nullptr);
@@ -239,11 +575,14 @@ namespace wpp {
             }
             this->_param_lengths.clear();
             this->_param_values.clear();
+            this->_param_pointers.clear();
+            this->_param_buffers.clear();
+            this->_param_server_types.clear();
             this->_param_formats.clear();
             this->_param_types.clear();
             this->_query.clear();
             if (!this->_cursor_name.empty()) {
-                std::string q = nullptr;
+                std::string q;
                 PGresult *res;
                 std::stringstream ss;
                 ss << boost::format("CLOSE %s") % this->_cursor_name;
@@ -252,7 +591,7 @@ namespace wpp {
                 if (res) {
                     PQclear(res);
                 }
-                this->_cursor_name = nullptr;
+                this->_cursor_name.clear();
             }
             if (!this->_cols.empty()) {
                 this->_cols.clear();
@@ -261,10 +600,10 @@ namespace wpp {
 
         int pgsql_statement::get_cursor_result() {
             ExecStatusType status;
-            std::string q = nullptr;
+            std::string q;
             if (this->_is_prepared) {
                 q = "CLOSE " + this->_cursor_name;
-                this->_result = PQexec(this->_H->_server, q.c_str());
+                PQclear(PQexec(this->_H->_server, q.c_str()));
             }
             q = "DECLARE " + this->_cursor_name + " SCROLL CURSOR WITH HOLD FOR " + this->_active_query_string;
             this->_result = PQexec(this->_H->_server, q.c_str());
@@ -277,12 +616,64 @@ namespace wpp {
                                                __LINE__);
                 return 0;
             }
+            PQclear(this->_result);
             this->_is_prepared = 1;
+            /* an empty block: it only describes the columns */
             q = "FETCH FORWARD 0 FROM " + this->_cursor_name;
             this->_result = PQexec(this->_H->_server, q.c_str());
+            this->_position = 0;
+            this->_server_position = 0;
+            this->_block_start = 1;
+            this->_cursor_rows = -1;
+            return 1;
+        }
+
+        int pgsql_statement::fetch_cursor_block(long target) {
+            /* blocks end at the target when going backwards, so PRIOR is served locally too */
+            const long window = std::max(1L, this->_prefetch);
+            const long start = target < this->_position ? std::max(1L, target - window + 1) : target;
+            std::string q;
+            if (this->_server_position != start - 1) {
+                q = "MOVE ABSOLUTE " + std::to_string(start - 1) + " IN " + this->_cursor_name + ";";
+            }
+            q += "FETCH FORWARD " + std::to_string(window) + " FROM " + this->_cursor_name;
+            if (this->_result) {
+                PQclear(this->_result);
+            }
+            this->_result = PQexec(this->_H->_server, q.c_str());
+            ExecStatusType status = PQresultStatus(this->_result);
+            if (status != PGRES_COMMAND_OK && status != PGRES_TUPLES_OK) {
+                pgsql_data_object::pgsql_error((pgsql_data_object *) this->_dbh, this, status,
+                                               PQresultErrorField(this->_result, PG_DIAG_SQLSTATE), "",
+                                               __FILE__, __LINE__);
+                PQclear(this->_result);
+                this->_result = nullptr;
+                this->_server_position = -1;
+                return 0;
+            }
+            const long rows = PQntuples(this->_result);
+            this->_block_start = start;
+            /* past the end the server position is one after the last row, which we may not know */
+            this->_server_position = rows == window ? start - 1 + rows : -1;
+            if (rows < window) {
+                this->_cursor_rows = start - 1 + rows;
+            }
             return 1;
         }
 
+        long pgsql_statement::cursor_row_count() {
+            if (this->_cursor_rows < 0) {
+                std::string q = "MOVE ABSOLUTE 0 IN " + this->_cursor_name + ";MOVE FORWARD ALL IN " + this->_cursor_name;
+                PGresult *res = PQexec(this->_H->_server, q.c_str());
+                if (PQresultStatus(res) == PGRES_COMMAND_OK) {
+                    this->_cursor_rows = std::atol(PQcmdTuples(res));
+                }
+                PQclear(res);
+                this->_server_position = -1;
+            }
+            return this->_cursor_rows;
+        }
+
         int pgsql_statement::prepare() {
             ExecStatusType status;
             bool stmt_retry;
@@ -298,6 +689,10 @@ namespace wpp {
                         /* it worked */
                         this->_is_prepared = 1;
                         PQclear(this->_result);
+                        this->_result = nullptr;
+                        if (!this->describe_prepared()) {
+                            return 0;
+                        }
                         break;
                     default: {
                         std::string sqlstate = PQresultErrorField(this->_result, PG_DIAG_SQLSTATE);
@@ -322,14 +717,41 @@ namespace wpp {
             return 1;
         }
 
-        int pgsql_statement::execute_prepared() {
-            const char **char_param = new const char *[this->_param_values.size()];
-            for (int i = 0; i < this->_param_values.size(); ++i) {
-                char_param[i] = this->_param_values[i].c_str();
+        int pgsql_statement::describe_prepared() {
+            bool has_native_param = false;
+            for (std::pair<const std::string, bound_param_data> &item : this->_bound_param) {
+                const param_type type = item.second.param_type;
+                has_native_param |= type == PARAM_INT || type == PARAM_FLOAT || type == PARAM_BOOL;
+            }
+            if (!has_native_param) {
+                return 1;
+            }
+            /* one round trip per statement, so that numbers and booleans can go in binary */
+            PGresult *res = PQdescribePrepared(this->_H->_server, this->_stmt_name.c_str());
+            if (PQresultStatus(res) != PGRES_COMMAND_OK) {
+                /* not fatal: the parameters keep the text format */
+                PQclear(res);
+                return 1;
+            }
+            this->_param_server_types.resize(PQnparams(res));
+            for (int i = 0; i < PQnparams(res); ++i) {
+                this->_param_server_types[i] = PQparamtype(res, i);
+            }
+            PQclear(res);
+            /* the first execution encoded its parameters before the types were known */
+            for (std::pair<const std::string, bound_param_data> &item : this->_bound_param) {
+                if (item.second.paramno >= 0 && item.second.paramno < (long) this->_param_pointers.size() &&
+                    !this->encode_param(item.second)) {
+                    return 0;
+                }
             }
+            return 1;
+        }
+
+        int pgsql_statement::execute_prepared() {
             this->_result = PQexecPrepared(this->_H->_server, this->_stmt_name.c_str(),
                                            this->_bound_param.size(),
-                                           char_param,
+                                           this->_param_pointers.data(),
                                            this->_param_lengths.data(),
                                            this->_param_formats.data(),
                                            0);
@@ -337,14 +759,10 @@ namespace wpp {
         }
 
         int pgsql_statement::execute_with_param() {
-            const char **char_param = new const char *[this->_param_values.size()];
-            for (int i = 0; i < this->_param_values.size(); ++i) {
-                char_param[i] = this->_param_values[i].c_str();
-            }
             this->_result = PQexecParams(this->_H->_server, this->_query.c_str(),
                                          this->_bound_param.size(),
                                          this->_param_types.data(),
-                                         (const char **) char_param,
+                                         this->_param_pointers.data(),
                                          this->_param_lengths.data(),
                                          this->_param_formats.data(),
                                          0);
@@ -388,6 +806,20 @@ namespace wpp {
             }
             this->_current_row = 0;
             const bool statement_has_cursor = !this->_cursor_name.empty();
+            if (this->_streaming > 0 && !statement_has_cursor) {
+                /* rows are pulled by the fetcher as they arrive */
+                this->drain_stream();
+                if (!this->send_query() || !this->next_stream_result()) {
+                    return 0;
+                }
+                this->update_row_and_column_count(PQresultStatus(this->_result));
+                if (PQresultStatus(this->_result) == PGRES_COMMAND_OK) {
+                    this->drain_stream();
+                } else {
+                    this->_row_count = 0;
+                }
+                return 1;
+            }
             if (statement_has_cursor) {
                 if (!this->get_cursor_result()) {
                     return 0;
@@ -419,108 +851,467 @@ namespace wpp {
             return 1;
         }
 
-        int pgsql_statement::fetcher(fetch_orientation ori, long offset) {
-            if (!this->_cursor_name.empty()) {
-                std::string ori_str = nullptr;
-                std::string q = nullptr;
-                ExecStatusType status;
-                switch (ori) {
-                    case FETCH_ORI_NEXT:
-                        ori_str = "NEXT";
-                        break;
-                    case FETCH_ORI_PRIOR:
-                        ori_str = "BACKWARD";
-                        break;
-                    case FETCH_ORI_FIRST:
-                        ori_str = "FIRST";
-                        break;
-                    case FETCH_ORI_LAST:
-                        ori_str = "LAST";
-                        break;
-                    case FETCH_ORI_ABS:
-                        ori_str = "ABSOLUTE " + std::to_string(offset);
+        void pgsql_statement::batch_row_values(const std::vector<batch_column> &columns, size_t row,
+                                               std::vector<std::string> &text, std::vector<const char *> &values) {
+            for (size_t col = 0; col < columns.size(); ++col) {
+                switch (columns[col].type()) {
+                    case PARAM_INT:
+                        text[col] = std::to_string(columns[col].get_int(row));
+                        values[col] = text[col].c_str();
                         break;
-                    case FETCH_ORI_REL:
-                        ori_str = "RELATIVE " + std::to_string(offset);
+                    case PARAM_FLOAT:
+                        text[col] = field_view::format_real(columns[col].get_real(row));
+                        values[col] = text[col].c_str();
                         break;
                     default:
-                        return 0;
-                }
-                q = "FETCH " + ori_str + " FROM " + this->_cursor_name;
-                this->_result = PQexec(this->_H->_server, q.c_str());
-                status = PQresultStatus(this->_result);
-                if (status != PGRES_COMMAND_OK && status != PGRES_TUPLES_OK) {
-                    pgsql_data_object::pgsql_error((pgsql_data_object *) this->_dbh, this, status,
-                                                   PQresultErrorField(this->_result, PG_DIAG_SQLSTATE), "",
-                                                   __FILE__,
-                                                   __LINE__);
-                    return 0;
-                }
-                if (PQntuples(this->_result)) {
-                    this->_current_row = 1;
-                    return 1;
-                } else {
-                    return 0;
-                }
-            } else {
-                if (this->_current_row < this->_row_count) {
-                    this->_current_row++;
-                    return 1;
-                } else {
-                    return 0;
+                        /* strings are sent from the caller's buffer */
+                        values[col] = columns[col].get_string(row).c_str();
                 }
             }
         }
 
-        int pgsql_statement::describer(int colno) {
-            //pgsql_statement *S = (pgsql_statement*)this->_driver_data;
-            std::vector<column_data> &cols = this->_columns;
-            struct pdo_bound_param_data *param;
-            std::string str;
-            if (!this->_result) {
+        int pgsql_statement::batch_executer(const std::vector<batch_column> &columns, size_t rows) {
+            if (this->_query.empty() || !this->_cursor_name.empty()) {
+                /* emulated prepares and cursors go through the generic row by row path */
+                return data_object_statement::batch_executer(columns, rows);
+            }
+            PGconn *conn = this->_H->_server;
+            const int n_params = (int) columns.size();
+            std::vector<std::string> text(columns.size());
+            std::vector<const char *> values(columns.size());
+            long changes = 0;
+            if (this->_result) {
+                PQclear(this->_result);
+                this->_result = nullptr;
+            }
+            /* the query is parsed and planned once: a named statement is prepared as usual, while
+             * statements without a name use the unnamed one, which lasts until the next unnamed prepare */
+            const std::string &name = this->_stmt_name;
+            if (!name.empty() && !this->_is_prepared && !this->prepare()) {
                 return 0;
             }
-            str = PQfname(this->_result, colno);
-            cols[colno].name = str;
-            cols[colno].maxlen = PQfsize(this->_result, colno);
-            cols[colno].precision = PQfmod(this->_result, colno);
-            this->_cols[colno].pgsql_type = PQftype(this->_result, colno);
-            switch (this->_cols[colno].pgsql_type) {
-                case pgsql_statement::BOOLOID:
-                    cols[colno].param_type = PARAM_BOOL;
-                    break;
-                case pgsql_statement::OIDOID: {
-                    const std::unordered_map<std::string, bound_param_data>::const_iterator param = this->_bound_columns.find(
-                            cols[colno].name);
-                    if (param != this->_bound_columns.end()) {
-                        if (param->second.param_type == PARAM_LOB) {
-                            cols[colno].param_type = PARAM_LOB;
-                            break;
-                        }
+            #ifdef LIBPQ_HAS_PIPELINING
+            /* all queries up to the sync run as one implicit transaction, with a single round trip per window */
+            const size_t window = 256;
+            if (!PQenterPipelineMode(conn)) {
+                pgsql_data_object::pgsql_error(this->_H, this, PGRES_FATAL_ERROR, "", "", __FILE__, __LINE__);
+                return 0;
+            }
+            bool failed = false;
+            bool prepare_pending = name.empty();
+            if (prepare_pending && !PQsendPrepare(conn, "", this->_query.c_str(), n_params, nullptr)) {
+                pgsql_data_object::pgsql_error(this->_H, this, PGRES_FATAL_ERROR, "", "", __FILE__, __LINE__);
+                failed = true;
+            }
+            for (size_t first = 0; first < rows && !failed; first += window) {
+                const size_t last = std::min(rows, first + window);
+                for (size_t row = first; row < last; ++row) {
+                    batch_row_values(columns, row, text, values);
+                    if (!PQsendQueryPrepared(conn, name.c_str(), n_params, values.data(), nullptr, nullptr, 0)) {
+                        pgsql_data_object::pgsql_error(this->_H, this, PGRES_FATAL_ERROR, "", "", __FILE__, __LINE__);
+                        failed = true;
+                        break;
                     }
-                    cols[colno].param_type = PARAM_INT;
+                }
+                if (failed) {
                     break;
                 }
-                case pgsql_statement::INT2OID:
-                case pgsql_statement::INT4OID:
-                    cols[colno].param_type = PARAM_INT;
+                if (!PQsendFlushRequest(conn) || PQflush(conn) != 0) {
+                    pgsql_data_object::pgsql_error(this->_H, this, PGRES_FATAL_ERROR, "", "", __FILE__, __LINE__);
+                    failed = true;
                     break;
-                case pgsql_statement::INT8OID:
-                    if (sizeof(long) >= 8) {
-                        cols[colno].param_type = PARAM_INT;
-                    } else {
-                        cols[colno].param_type = PARAM_STR;
+                }
+                if (prepare_pending) {
+                    PGresult *res = PQgetResult(conn);
+                    const ExecStatusType status = PQresultStatus(res);
+                    if (status != PGRES_COMMAND_OK) {
+                        const char *sqlstate = PQresultErrorField(res, PG_DIAG_SQLSTATE);
+                        pgsql_data_object::pgsql_error(this->_H, this, status, sqlstate ? sqlstate : "",
+                                                       res ? PQresultErrorMessage(res) : "", __FILE__, __LINE__);
+                        failed = true;
                     }
-                    break;
-                case pgsql_statement::BYTEAOID:
-                    cols[colno].param_type = PARAM_LOB;
-                    break;
-                default:
-                    cols[colno].param_type = PARAM_STR;
-            }
-            return 1;
-        }
-
+                    PQclear(res);
+                    while ((res = PQgetResult(conn)) != nullptr) {
+                        PQclear(res);
+                    }
+                    prepare_pending = false;
+                }
+                /* read this window before sending more, so neither side blocks on a full buffer */
+                for (size_t row = first; row < last && !failed; ++row) {
+                    PGresult *res = PQgetResult(conn);
+                    ExecStatusType status = PQresultStatus(res);
+                    if (status == PGRES_COMMAND_OK || status == PGRES_TUPLES_OK) {
+                        changes += std::atol(PQcmdTuples(res));
+                    } else if (!failed) {
+                        const char *sqlstate = PQresultErrorField(res, PG_DIAG_SQLSTATE);
+                        pgsql_data_object::pgsql_error(this->_H, this, status, sqlstate ? sqlstate : "",
+                                                       res ? PQresultErrorMessage(res) : "", __FILE__, __LINE__);
+                        failed = true;
+                    }
+                    PQclear(res);
+                    /* each query ends with a null result */
+                    while ((res = PQgetResult(conn)) != nullptr) {
+                        PQclear(res);
+                    }
+                }
+            }
+            /* skip whatever is left (aborted queries) up to the sync */
+            if (PQpipelineSync(conn)) {
+                for (;;) {
+                    PGresult *res = PQgetResult(conn);
+                    if (!res) {
+                        if (PQstatus(conn) != CONNECTION_OK) {
+                            break;
+                        }
+                        continue;
+                    }
+                    const ExecStatusType status = PQresultStatus(res);
+                    PQclear(res);
+                    if (status == PGRES_PIPELINE_SYNC) {
+                        break;
+                    }
+                }
+            }
+            PQexitPipelineMode(conn);
+            if (failed) {
+                return 0;
+            }
+            #else
+            /* without pipelining, at least avoid one commit per row */
+            if (name.empty()) {
+                PGresult *res = PQprepare(conn, "", this->_query.c_str(), n_params, nullptr);
+                const ExecStatusType status = PQresultStatus(res);
+                if (status != PGRES_COMMAND_OK) {
+                    const char *sqlstate = PQresultErrorField(res, PG_DIAG_SQLSTATE);
+                    pgsql_data_object::pgsql_error(this->_H, this, status, sqlstate ? sqlstate : "", "",
+                                                   __FILE__, __LINE__);
+                    PQclear(res);
+                    return 0;
+                }
+                PQclear(res);
+            }
+            const bool implicit_transaction = PQtransactionStatus(conn) == PQTRANS_IDLE;
+            if (implicit_transaction && !this->_H->transaction_cmd("BEGIN")) {
+                return 0;
+            }
+            for (size_t row = 0; row < rows; ++row) {
+                batch_row_values(columns, row, text, values);
+                PGresult *res = PQexecPrepared(conn, name.c_str(), n_params, values.data(), nullptr, nullptr, 0);
+                ExecStatusType status = PQresultStatus(res);
+                if (status != PGRES_COMMAND_OK && status != PGRES_TUPLES_OK) {
+                    const char *sqlstate = PQresultErrorField(res, PG_DIAG_SQLSTATE);
+                    pgsql_data_object::pgsql_error(this->_H, this, status, sqlstate ? sqlstate : "", "",
+                                                   __FILE__, __LINE__);
+                    PQclear(res);
+                    if (implicit_transaction) {
+                        this->_H->transaction_cmd("ROLLBACK");
+                    }
+                    return 0;
+                }
+                changes += std::atol(PQcmdTuples(res));
+                PQclear(res);
+            }
+            if (implicit_transaction && !this->_H->transaction_cmd("COMMIT")) {
+                return 0;
+            }
+            #endif
+            this->_row_count = changes;
+            return 1;
+        }
+
+        int pgsql_statement::send_query() {
+            PGconn *conn = this->_H->_server;
+            int sent;
+            if (!this->_stmt_name.empty()) {
+                if (!this->_is_prepared && !this->prepare()) {
+                    return 0;
+                }
+                sent = PQsendQueryPrepared(conn, this->_stmt_name.c_str(), this->_bound_param.size(), this->_param_pointers.data(),
+                                           this->_param_lengths.data(), this->_param_formats.data(), 0);
+            } else if (this->_supports_placeholders == PLACEHOLDER_NAMED) {
+                sent = PQsendQueryParams(conn, this->_query.c_str(), this->_bound_param.size(),
+                                         this->_param_types.data(), this->_param_pointers.data(), this->_param_lengths.data(),
+                                         this->_param_formats.data(), 0);
+            } else {
+                sent = PQsendQuery(conn, this->_active_query_string.c_str());
+            }
+            if (!sent) {
+                pgsql_data_object::pgsql_error(this->_H, this, PGRES_FATAL_ERROR, "", "", __FILE__, __LINE__);
+                return 0;
+            }
+            #ifdef LIBPQ_HAS_CHUNK_MODE
+            if (this->_streaming > 1) {
+                PQsetChunkedRowsMode(conn, this->_streaming);
+            } else {
+                PQsetSingleRowMode(conn);
+            }
+            #else
+            /* without chunked mode, any streaming size means one row per result */
+            PQsetSingleRowMode(conn);
+            #endif
+            this->_stream_active = true;
+            return 1;
+        }
+
+        int pgsql_statement::next_stream_result() {
+            if (this->_result) {
+                PQclear(this->_result);
+                this->_result = nullptr;
+            }
+            this->_current_row = 0;
+            if (!this->_stream_active) {
+                return 0;
+            }
+            this->_result = PQgetResult(this->_H->_server);
+            ExecStatusType status = PQresultStatus(this->_result);
+            switch (status) {
+                case PGRES_SINGLE_TUPLE:
+                #ifdef LIBPQ_HAS_CHUNK_MODE
+                case PGRES_TUPLES_CHUNK:
+                #endif
+                case PGRES_TUPLES_OK:
+                case PGRES_COMMAND_OK:
+                    return 1;
+                default: {
+                    const char *sqlstate = this->_result ? PQresultErrorField(this->_result, PG_DIAG_SQLSTATE) : nullptr;
+                    pgsql_data_object::pgsql_error(this->_H, this, status, sqlstate ? sqlstate : "", "",
+                                                   __FILE__, __LINE__);
+                    this->drain_stream();
+                    return 0;
+                }
+            }
+        }
+
+        void pgsql_statement::drain_stream() {
+            if (!this->_stream_active) {
+                return;
+            }
+            /* the connection is busy until every result was read */
+            PGresult *res;
+            while ((res = PQgetResult(this->_H->_server)) != nullptr) {
+                PQclear(res);
+            }
+            this->_stream_active = false;
+        }
+
+        int pgsql_statement::send_execution(std::vector<std::pair<std::string, std::string>> &input_params,
+                                            bool pipelined, bool &sent_prepare) {
+            sent_prepare = false;
+            if (!this->_cursor_name.empty() || this->_streaming > 0) {
+                data_object::raise_impl_error(this->_dbh, this, "IM001",
+                                              "cursors and streamed statements can't be sent asynchronously");
+                return 0;
+            }
+            if (!this->bind_input_parameters(input_params)) {
+                return 0;
+            }
+            if (this->_supports_placeholders == PLACEHOLDER_NONE) {
+                if (!this->emulate_parameter_binding()) {
+                    return 0;
+                }
+            } else if (!this->dispatch_param_event(PARAM_EVT_EXEC_PRE)) {
+                return 0;
+            }
+            if (this->_result) {
+                PQclear(this->_result);
+                this->_result = nullptr;
+            }
+            this->_current_row = 0;
+            PGconn *conn = this->_H->_server;
+            int sent;
+            if (!this->_stmt_name.empty() && !this->_is_prepared && !pipelined) {
+                /* one command at a time outside a pipeline: run it unnamed rather than waiting for PQprepare */
+                sent = PQsendQueryParams(conn, this->_query.c_str(), this->_bound_param.size(),
+                                         this->_param_types.data(), this->_param_pointers.data(), this->_param_lengths.data(),
+                                         this->_param_formats.data(), 0);
+            } else if (!this->_stmt_name.empty()) {
+                /* PQprepare would wait for the server; the prepare goes down the pipeline instead */
+                if (!this->_is_prepared) {
+                    if (!PQsendPrepare(conn, this->_stmt_name.c_str(), this->_query.c_str(), this->_bound_param.size(),
+                                       this->_param_types.data())) {
+                        pgsql_data_object::pgsql_error(this->_H, this, PGRES_FATAL_ERROR, "", "", __FILE__, __LINE__);
+                        return 0;
+                    }
+                    sent_prepare = true;
+                    this->_is_prepared = true;
+                }
+                sent = PQsendQueryPrepared(conn, this->_stmt_name.c_str(), this->_bound_param.size(), this->_param_pointers.data(),
+                                           this->_param_lengths.data(), this->_param_formats.data(), 0);
+            } else if (this->_supports_placeholders == PLACEHOLDER_NAMED) {
+                sent = PQsendQueryParams(conn, this->_query.c_str(), this->_bound_param.size(),
+                                         this->_param_types.data(), this->_param_pointers.data(), this->_param_lengths.data(),
+                                         this->_param_formats.data(), 0);
+            } else if (pipelined) {
+                /* simple queries are not allowed in pipeline mode */
+                sent = PQsendQueryParams(conn, this->_active_query_string.c_str(), 0, nullptr, nullptr, nullptr,
+                                         nullptr, 0);
+            } else {
+                sent = PQsendQuery(conn, this->_active_query_string.c_str());
+            }
+            if (!sent) {
+                pgsql_data_object::pgsql_error(this->_H, this, PGRES_FATAL_ERROR, "", "", __FILE__, __LINE__);
+                if (sent_prepare) {
+                    /* the prepare is queued but nothing runs it: sent_prepare tells the caller to read its result */
+                    this->_is_prepared = false;
+                }
+                return 0;
+            }
+            return 1;
+        }
+
+        int pgsql_statement::receive_pipelined(PGresult *res) {
+            /* from here on, the same as a blocking execute */
+            if (this->_result) {
+                PQclear(this->_result);
+            }
+            this->_result = res;
+            ExecStatusType status;
+            if (!this->check_status(status)) {
+                return 0;
+            }
+            this->update_row_and_column_count(status);
+            int ret = 1;
+            if (!this->_executed) {
+                ret = this->first_execution(ret);
+            }
+            if (ret && !this->dispatch_param_event(PARAM_EVT_EXEC_POST)) {
+                return 0;
+            }
+            return ret;
+        }
+
+        int pgsql_statement::fetcher(fetch_orientation ori, long offset) {
+            if (this->_stream_active || (this->_streaming > 0 && this->_cursor_name.empty())) {
+                if (ori != FETCH_ORI_NEXT) {
+                    data_object::raise_impl_error(this->_dbh, this, "HY106", "streamed results are forward only");
+                    return 0;
+                }
+                /* the last result marks the end, and only carries the column descriptions */
+                while (this->_result && this->_current_row >= PQntuples(this->_result)) {
+                    if (PQresultStatus(this->_result) == PGRES_TUPLES_OK ||
+                        PQresultStatus(this->_result) == PGRES_COMMAND_OK) {
+                        this->drain_stream();
+                        return 0;
+                    }
+                    if (!this->next_stream_result()) {
+                        return 0;
+                    }
+                }
+                if (!this->_result) {
+                    return 0;
+                }
+                this->_current_row++;
+                this->_row_count++;
+                return 1;
+            }
+            if (!this->_cursor_name.empty()) {
+                /* positions are 1-based rows of the cursor; 0 is before the first row */
+                long target;
+                switch (ori) {
+                    case FETCH_ORI_NEXT:
+                        target = this->_position + 1;
+                        break;
+                    case FETCH_ORI_PRIOR:
+                        target = this->_position - 1;
+                        break;
+                    case FETCH_ORI_FIRST:
+                        target = 1;
+                        break;
+                    case FETCH_ORI_LAST:
+                        target = this->cursor_row_count();
+                        break;
+                    case FETCH_ORI_ABS:
+                        target = offset >= 0 ? offset : this->cursor_row_count() + 1 + offset;
+                        break;
+                    case FETCH_ORI_REL:
+                        target = this->_position + offset;
+                        break;
+                    default:
+                        return 0;
+                }
+                if (target < 1) {
+                    this->_position = 0;
+                    return 0;
+                }
+                if (this->_cursor_rows >= 0 && target > this->_cursor_rows) {
+                    this->_position = this->_cursor_rows + 1;
+                    return 0;
+                }
+                const long block_rows = this->_result ? PQntuples(this->_result) : 0;
+                const bool in_block = target >= this->_block_start && target < this->_block_start + block_rows;
+                if (!in_block && !this->fetch_cursor_block(target)) {
+                    return 0;
+                }
+                if (target >= this->_block_start + PQntuples(this->_result)) {
+                    this->_position = target;
+                    return 0;
+                }
+                this->_position = target;
+                this->_current_row = target - this->_block_start + 1;
+                return 1;
+            } else {
+                if (this->_current_row < this->_row_count) {
+                    this->_current_row++;
+                    return 1;
+                } else {
+                    return 0;
+                }
+            }
+        }
+
+        int pgsql_statement::describer(int colno) {
+            //pgsql_statement *S = (pgsql_statement*)this->_driver_data;
+            std::vector<column_data> &cols = this->_columns;
+            struct pdo_bound_param_data *param;
+            std::string str;
+            if (!this->_result) {
+                return 0;
+            }
+            str = PQfname(this->_result, colno);
+            cols[colno].name = str;
+            cols[colno].maxlen = PQfsize(this->_result, colno);
+            cols[colno].precision = PQfmod(this->_result, colno);
+            this->_cols[colno].pgsql_type = PQftype(this->_result, colno);
+            switch (this->_cols[colno].pgsql_type) {
+                case pgsql_statement::BOOLOID:
+                    cols[colno].param_type = PARAM_BOOL;
+                    break;
+                case pgsql_statement::OIDOID: {
+                    const std::unordered_map<std::string, bound_param_data>::const_iterator param = this->_bound_columns.find(
+                            cols[colno].name);
+                    if (param != this->_bound_columns.end()) {
+                        if (param->second.param_type == PARAM_LOB) {
+                            cols[colno].param_type = PARAM_LOB;
+                            break;
+                        }
+                    }
+                    cols[colno].param_type = PARAM_INT;
+                    break;
+                }
+                case pgsql_statement::INT2OID:
+                case pgsql_statement::INT4OID:
+                    cols[colno].param_type = PARAM_INT;
+                    break;
+                case pgsql_statement::INT8OID:
+                    if (sizeof(long) >= 8) {
+                        cols[colno].param_type = PARAM_INT;
+                    } else {
+                        cols[colno].param_type = PARAM_STR;
+                    }
+                    break;
+                case pgsql_statement::FLOAT4OID:
+                case pgsql_statement::FLOAT8OID:
+                    cols[colno].param_type = PARAM_FLOAT;
+                    break;
+                case pgsql_statement::BYTEAOID:
+                    cols[colno].param_type = PARAM_LOB;
+                    break;
+                default:
+                    cols[colno].param_type = PARAM_STR;
+            }
+            return 1;
+        }
+
         int pgsql_statement::get_col(int colno, std::string &ptr, int &caller_frees) {
             std::vector<column_data> &cols = this->_columns;
             if (!this->_result) {
@@ -529,25 +1320,47 @@ namespace wpp {
             if (PQgetisnull(this->_result, this->_current_row - 1, colno)) {
                 ptr.clear();
             } else {
-                ptr = PQgetvalue(this->_result, this->_current_row - 1, colno);
-                switch (cols[colno].param_type) {
-                    case PARAM_INT:
-                        this->_cols[colno].intval = std::stol(ptr);
-                        ptr = std::to_string(this->_cols[colno].intval);
-                        break;
-                    case PARAM_BOOL:
-                        this->_cols[colno].boolval = (ptr[0] == 't' || ptr[0] == 'T') ? 1 : 0;
-                        ptr = this->_cols[colno].boolval ? "true" : "false";
-                        break;
-                    case PARAM_NULL:
-                    case PARAM_STR:
-                    default:
-                        break;
+                /* the server text is already canonical for numbers, no need to round trip it */
+                ptr.assign(PQgetvalue(this->_result, this->_current_row - 1, colno),
+                           PQgetlength(this->_result, this->_current_row - 1, colno));
+                if (cols[colno].param_type == PARAM_BOOL) {
+                    ptr = (ptr[0] == 't' || ptr[0] == 'T') ? "true" : "false";
                 }
             }
             return 1;
         }
 
+        int pgsql_statement::col_is_null(int colno) {
+            return this->_result && PQgetisnull(this->_result, this->_current_row - 1, colno);
+        }
+
+        int pgsql_statement::get_col_view(int colno, field_view &value) {
+            if (!this->_result) {
+                return 0;
+            }
+            if (PQgetisnull(this->_result, this->_current_row - 1, colno)) {
+                value = field_view();
+                return 1;
+            }
+            const char *text = PQgetvalue(this->_result, this->_current_row - 1, colno);
+            size_t size = PQgetlength(this->_result, this->_current_row - 1, colno);
+            /* text results are null terminated, so the OID tells how to parse them in place */
+            switch (this->_columns[colno].param_type) {
+                case PARAM_INT:
+                    value = field_view((int64_t) std::strtoll(text, nullptr, 10), text, size);
+                    break;
+                case PARAM_FLOAT:
+                    value = field_view(std::strtod(text, nullptr), text, size);
+                    break;
+                case PARAM_BOOL:
+                    value = field_view(text[0] == 't' || text[0] == 'T', text, size);
+                    break;
+                default:
+                    value = field_view(text, size);
+            }
+            return 1;
+        }
+
         int pgsql_statement::param_hook(bound_param_data &param, param_event event_type) {
             const bool named_placeholders = this->_supports_placeholders == PLACEHOLDER_NAMED && param.is_param;
             if (named_placeholders) {
@@ -590,71 +1403,159 @@ namespace wpp {
                         if (this->_bound_param_map.empty()) {
                             return 1;
                         }
-                        if (this->_param_values.empty()) {
+                        if (this->_param_pointers.size() < this->_bound_param.size()) {
                             this->_param_values.resize(this->_bound_param.size());
+                            this->_param_pointers.resize(this->_bound_param.size());
+                            this->_param_buffers.resize(this->_bound_param.size());
                             this->_param_lengths.resize(this->_bound_param.size());
                             this->_param_formats.resize(this->_bound_param.size());
                             this->_param_types.resize(this->_bound_param.size());
                         }
                         if (param.paramno >= 0) {
-                            std::string parameter = byte_to_string(param.parameter_typeinfo, param.parameter);
-                            switch (param.param_type) {
-                                case PARAM_NULL:
-                                    this->_param_values[param.paramno] = "";
-                                    this->_param_lengths[param.paramno] = 0;
-                                    break;
-                                case PARAM_BOOL:
-                                    this->_param_values[param.paramno] = (parameter[0] == 't') ? "t" : "f";
-                                    this->_param_lengths[param.paramno] = 1;
-                                    this->_param_formats[param.paramno] = 0;
-                                    break;
-                                case PARAM_LOB:
-                                    return 0;
-                                default:
-                                    this->_param_values[param.paramno] = parameter;
-                                    this->_param_lengths[param.paramno] = parameter.length();
-                                    this->_param_formats[param.paramno] = 0;
-                            }
-                            if (param.param_type == PARAM_LOB) {
-                                this->_param_types[param.paramno] = 0;
-                                this->_param_formats[param.paramno] = 1;
-                            } else {
-                                this->_param_types[param.paramno] = 0;
-                            }
+                            return this->encode_param(param);
                         }
                         break;
                 }
             } else if (param.is_param) {
                 if (param.param_type == PARAM_BOOL) {
-                    const std::string s = ((*((std::string *) param.parameter))[0] == 't' ||
-                                           (*((std::string *) param.parameter))[0] == '0') ? "t" : "f";
+                    /* emulated statements quote booleans as 't' and 'f' */
+                    bool value;
+                    if (param.parameter_tag == VALUE_STRING) {
+                        const std::string &text = *((std::string *) param.parameter);
+                        value = !text.empty() && (text[0] == 't' || text[0] == '1');
+                    } else {
+                        value = param_as<int64_t>(param) != 0;
+                    }
                     param.param_type = PARAM_STR;
-                    param.parameter_data.reset(new std::string(s));
-                    param.parameter = (void *) &param.parameter_data;
+                    param.is_native_copy = false;
+                    param.parameter_data.reset(new std::string(value ? "t" : "f"));
+                    param.parameter = (void *) param.parameter_data.get();
+                    param.parameter_tag = VALUE_STRING;
                 }
             }
             return 1;
         }
 
-        int pgsql_statement::get_column_meta(long colno, column_data &return_value) {
-            PGresult *res;
-            std::string q = "";
-            ExecStatusType status;
-            if (!this->_result) {
+        int pgsql_statement::encode_param(bound_param_data &param) {
+            const size_t i = param.paramno;
+            if (i >= this->_param_pointers.size()) {
+                pgsql_data_object::raise_impl_error(this->_dbh, this, "HY093", "parameter was not defined");
                 return 0;
             }
-            if (colno >= this->_columns.size()) {
-                return 0;
-            }
-            return_value.native_type = this->_cols[colno].pgsql_type;
-            Oid table_oid = PQftable(this->_result, colno);
-            return_value.native_table_id = table_oid;
-            std::string table_name = pgsql_statement::translate_oid_to_table(table_oid, this->_H->_server);
-            return_value.table = table_name;
-            switch (this->_cols[colno].pgsql_type) {
-                case pgsql_statement::BOOLOID:
-                    return_value.native_type = BOOLLABEL;
-                    break;
+            const Oid server_type = i < this->_param_server_types.size() ? this->_param_server_types[i] : 0;
+            char *buffer = this->_param_buffers[i].data();
+            /* binary values go in network byte order */
+            auto put_binary = [&](uint64_t value, int size) {
+                for (int k = size - 1; k >= 0; --k) {
+                    buffer[k] = (char) (value & 0xff);
+                    value >>= 8;
+                }
+                this->_param_pointers[i] = buffer;
+                this->_param_lengths[i] = size;
+                this->_param_formats[i] = 1;
+            };
+            auto put_text = [&](int size) {
+                this->_param_pointers[i] = buffer;
+                this->_param_lengths[i] = size;
+                this->_param_formats[i] = 0;
+            };
+            this->_param_types[i] = 0;
+            param_type type = param.parameter ? param.param_type : PARAM_NULL;
+            switch (type) {
+                case PARAM_NULL:
+                    this->_param_pointers[i] = nullptr;
+                    this->_param_lengths[i] = 0;
+                    this->_param_formats[i] = 0;
+                    return 1;
+                case PARAM_LOB:
+                    return 0;
+                case PARAM_INT: {
+                    if (param_exceeds_int64(param)) {
+                        /* the exact decimal text: the server rejects it for a bigint */
+                        this->_param_values[i] = byte_to_string(param.parameter_tag, param.parameter);
+                        this->_param_pointers[i] = this->_param_values[i].c_str();
+                        this->_param_lengths[i] = this->_param_values[i].size();
+                        this->_param_formats[i] = 0;
+                        return 1;
+                    }
+                    const int64_t value = param_as<int64_t>(param);
+                    if (server_type == INT8OID) {
+                        put_binary((uint64_t) value, 8);
+                    } else if (server_type == INT4OID && value >= INT32_MIN && value <= INT32_MAX) {
+                        put_binary((uint64_t) value, 4);
+                    } else if (server_type == INT2OID && value >= INT16_MIN && value <= INT16_MAX) {
+                        put_binary((uint64_t) value, 2);
+                    } else if (server_type == FLOAT8OID || server_type == FLOAT4OID) {
+                        break;
+                    } else {
+                        /* unknown or out of range: the server parses (and range checks) the text */
+                        put_text(std::snprintf(buffer, this->_param_buffers[i].size(), "%" PRId64, value));
+                    }
+                    return 1;
+                }
+                case PARAM_BOOL:
+                    if (server_type == BOOLOID) {
+                        put_binary(param_as<int64_t>(param) != 0, 1);
+                    } else {
+                        buffer[0] = param_as<int64_t>(param) != 0 ? 't' : 'f';
+                        put_text(1);
+                    }
+                    return 1;
+                case PARAM_FLOAT:
+                    break;
+                default:
+                    if (param.parameter_tag == VALUE_STRING) {
+                        const std::string *text = (const std::string *) param.parameter;
+                        this->_param_pointers[i] = text->c_str();
+                        this->_param_lengths[i] = text->size();
+                    } else {
+                        this->_param_values[i] = byte_to_string(param.parameter_tag, param.parameter);
+                        this->_param_pointers[i] = this->_param_values[i].c_str();
+                        this->_param_lengths[i] = this->_param_values[i].size();
+                    }
+                    this->_param_formats[i] = 0;
+                    return 1;
+            }
+            /* reals, and integers going into real columns */
+            const double value = param_as<double>(param);
+            if (server_type == FLOAT8OID) {
+                uint64_t bits;
+                std::memcpy(&bits, &value, sizeof(bits));
+                put_binary(bits, 8);
+            } else if (server_type == FLOAT4OID) {
+                const float narrow = (float) value;
+                uint32_t bits;
+                std::memcpy(&bits, &narrow, sizeof(bits));
+                put_binary(bits, 4);
+            } else if (value != value) {
+                put_text(std::snprintf(buffer, this->_param_buffers[i].size(), "NaN"));
+            } else if (value > std::numeric_limits<double>::max() || value < -std::numeric_limits<double>::max()) {
+                put_text(std::snprintf(buffer, this->_param_buffers[i].size(), value > 0 ? "Infinity" : "-Infinity"));
+            } else {
+                put_text(std::snprintf(buffer, this->_param_buffers[i].size(), "%.17g", value));
+            }
+            return 1;
+        }
+
+        int pgsql_statement::get_column_meta(long colno, column_data &return_value) {
+            PGresult *res;
+            std::string q = "";
+            ExecStatusType status;
+            if (!this->_result) {
+                return 0;
+            }
+            if (colno >= this->_columns.size()) {
+                return 0;
+            }
+            return_value.native_type = this->_cols[colno].pgsql_type;
+            Oid table_oid = PQftable(this->_result, colno);
+            return_value.native_table_id = table_oid;
+            std::string table_name = pgsql_statement::translate_oid_to_table(table_oid, this->_H->_server);
+            return_value.table = table_name;
+            switch (this->_cols[colno].pgsql_type) {
+                case pgsql_statement::BOOLOID:
+                    return_value.native_type = BOOLLABEL;
+                    break;
                 case pgsql_statement::BYTEAOID:
                     return_value.native_type = BYTEALABEL;
                     break;
@@ -694,10 +1595,47 @@ namespace wpp {
         }
 
         int pgsql_statement::cursor_closer() {
+            this->drain_stream();
             this->_cols.clear();
             return 1;
         }
 
+        int pgsql_statement::set_attribute_func(long attr, driver_option &val) {
+            switch (attr) {
+                case ATTR_PREFETCH:
+                    this->_prefetch = std::max(1L, (long) val.get_int());
+                    return 1;
+                case PGSQL_ATTR_STREAMING:
+                    if (this->_stream_active) {
+                        data_object::raise_impl_error(this->_dbh, this, "HY011",
+                                                      "streaming can't change while rows are pending");
+                        return 0;
+                    }
+                    this->_streaming = std::max(0, (int) val.get_int());
+                    return 1;
+                default:
+                    return 0;
+            }
+        }
+
+        int pgsql_statement::get_attribute(long attr, driver_option &val) {
+            switch (attr) {
+                case ATTR_PREFETCH:
+                    val = (int) this->_prefetch;
+                    return 1;
+                case PGSQL_ATTR_STREAMING:
+                    val = this->_streaming;
+                    return 1;
+                default:
+                    return 0;
+            }
+        }
+
+        int pgsql_statement::peek_attribute(long attr, driver_option &val) {
+            /* get_attribute only reads members */
+            return this->get_attribute(attr, val) == 1;
+        }
+
         std::string pgsql_statement::translate_oid_to_table(Oid oid, PGconn *conn) {
             PGresult *tmp_res;
             std::string querystr = "";
@@ -778,6 +1716,8 @@ namespace wpp {
         }
 
         pgsql_data_object::~pgsql_data_object() {
+            /* cached statements deallocate themselves on the server */
+            this->_statement_cache.clear();
             if (this->_server) {
                 PQfinish(this->_server);
             }
@@ -791,6 +1731,14 @@ namespace wpp {
             int emulate = 0;
             int execute_only = 0;
             stmt->_H = this;
+            auto prefetch = driver_options.find(ATTR_PREFETCH);
+            if (prefetch != driver_options.end()) {
+                stmt->_prefetch = std::max(1L, (long) prefetch->second.get_int());
+            }
+            auto streaming = driver_options.find((wpp::db::attribute_type) PGSQL_ATTR_STREAMING);
+            if (streaming != driver_options.end()) {
+                stmt->_streaming = std::max(0, (int) streaming->second.get_int());
+            }
             int scrollable;
             auto iter = driver_options.find(ATTR_CURSOR);
             if (iter != driver_options.end()) {
@@ -1091,6 +2039,857 @@ namespace wpp {
             }
             return nullptr;
         }
+        pgsql_copy_writer pgsql_data_object::copy_in(const std::string &table, copy_format format) {
+            std::string q = "COPY " + table + " FROM STDIN";
+            if (format == COPY_BINARY) {
+                q += " (FORMAT binary)";
+            }
+            PGresult *res = PQexec(this->_server, q.c_str());
+            ExecStatusType status = PQresultStatus(res);
+            if (status != PGRES_COPY_IN) {
+                const char *sqlstate = PQresultErrorField(res, PG_DIAG_SQLSTATE);
+                pgsql_data_object::pgsql_error(this, nullptr, status, sqlstate ? sqlstate : "", "", __FILE__, __LINE__);
+                PQclear(res);
+                data_object::handle_error(*this);
+                return pgsql_copy_writer();
+            }
+            PQclear(res);
+            return pgsql_copy_writer(this, format);
+        }
+
+        long pgsql_data_object::copy_in(const std::string &table, const std::vector<batch_column> &columns,
+                                        copy_format format) {
+            pgsql_copy_writer writer = this->copy_in(table, format);
+            if (!writer || !writer.write_columns(columns)) {
+                return -1;
+            }
+            return writer.end();
+        }
+
+        template<typename... Ts>
+        long pgsql_data_object::copy_in(const std::string &table, const std::vector<std::tuple<Ts...>> &rows,
+                                        copy_format format) {
+            pgsql_copy_writer writer = this->copy_in(table, format);
+            if (!writer) {
+                return -1;
+            }
+            for (const std::tuple<Ts...> &row : rows) {
+                if (!writer.write_row(row)) {
+                    return -1;
+                }
+            }
+            return writer.end();
+        }
+
+        pgsql_pipeline pgsql_data_object::pipeline() {
+            #ifdef LIBPQ_HAS_PIPELINING
+            if (!PQenterPipelineMode(this->_server)) {
+                pgsql_data_object::pgsql_error(this, nullptr, PGRES_FATAL_ERROR, "", "", __FILE__, __LINE__);
+                data_object::handle_error(*this);
+                return pgsql_pipeline();
+            }
+            #endif
+            return pgsql_pipeline(this);
+        }
+
+        pgsql_copy_reader pgsql_data_object::copy_out(const std::string &source, copy_format format) {
+            std::string q = "COPY " + source + " TO STDOUT";
+            if (format == COPY_BINARY) {
+                q += " (FORMAT binary)";
+            }
+            PGresult *res = PQexec(this->_server, q.c_str());
+            ExecStatusType status = PQresultStatus(res);
+            if (status != PGRES_COPY_OUT) {
+                const char *sqlstate = PQresultErrorField(res, PG_DIAG_SQLSTATE);
+                pgsql_data_object::pgsql_error(this, nullptr, status, sqlstate ? sqlstate : "", "", __FILE__, __LINE__);
+                PQclear(res);
+                data_object::handle_error(*this);
+                return pgsql_copy_reader();
+            }
+            PQclear(res);
+            return pgsql_copy_reader(this, format);
+        }
+
+        long pgsql_data_object::copy_out(const std::string &source, std::function<bool(boost::string_view)> callback,
+                                         copy_format format) {
+            pgsql_copy_reader reader = this->copy_out(source, format);
+            if (!reader) {
+                return -1;
+            }
+            boost::string_view chunk;
+            while (reader.next(chunk)) {
+                if (!callback(chunk)) {
+                    return -1;
+                }
+            }
+            return reader.row_count();
+        }
+
+        ///////////////////////////////////////////////////////////////
+        //                      PIPELINE DEFINITIONS                 //
+        ///////////////////////////////////////////////////////////////
+        pgsql_pipeline::pgsql_pipeline(pgsql_data_object *dbh) : _dbh(dbh) {}
+
+        pgsql_pipeline::~pgsql_pipeline() {
+            if (!this->_dbh) {
+                return;
+            }
+            /* errors are already in the futures; nothing may escape a destructor */
+            try {
+                this->sync();
+            } catch (...) {
+            }
+            #ifdef LIBPQ_HAS_PIPELINING
+            PQexitPipelineMode(this->_dbh->_server);
+            #endif
+        }
+
+        std::future<bool> pgsql_pipeline::execute(const std::shared_ptr<data_object_statement> &stmt,
+                                                  std::vector<std::pair<std::string, std::string>> input_parameters) {
+            pending_execution execution{std::dynamic_pointer_cast<pgsql_statement>(stmt), std::promise<bool>(), false};
+            std::future<bool> result = execution.promise.get_future();
+            if (!this->_dbh || !execution.stmt || execution.stmt->_H != this->_dbh) {
+                execution.promise.set_exception(std::make_exception_ptr(
+                        std::invalid_argument("statement does not belong to this pipeline's connection")));
+                return result;
+            }
+            for (const pending_execution &queued : this->_pending) {
+                if (queued.stmt == execution.stmt && queued.sent_execution) {
+                    /* a statement holds one result: the second would overwrite the rows of the first */
+                    execution.promise.set_exception(std::make_exception_ptr(
+                            std::invalid_argument("statement is already queued in this pipeline")));
+                    return result;
+                }
+            }
+            #ifdef LIBPQ_HAS_PIPELINING
+            execution.stmt->_error_code = "000000";
+            if (!execution.stmt->send_execution(input_parameters, true, execution.sent_prepare)) {
+                pgsql_pipeline::fail(execution);
+                if (execution.sent_prepare) {
+                    /* its result comes back before those of the executions queued next */
+                    execution.sent_execution = false;
+                    this->_pending.push_back(std::move(execution));
+                }
+                return result;
+            }
+            this->_pending.push_back(std::move(execution));
+            #else
+            /* without pipelining, the executions run one by one */
+            if (execution.stmt->execute(input_parameters)) {
+                execution.promise.set_value(true);
+            } else {
+                pgsql_pipeline::fail(execution);
+            }
+            #endif
+            return result;
+        }
+
+        bool pgsql_pipeline::sync() {
+            if (!this->_dbh) {
+                return false;
+            }
+            bool ok = true;
+            #ifdef LIBPQ_HAS_PIPELINING
+            PGconn *conn = this->_dbh->_server;
+            if (!PQpipelineSync(conn)) {
+                pgsql_data_object::pgsql_error(this->_dbh, nullptr, PGRES_FATAL_ERROR, "", "", __FILE__, __LINE__);
+                for (pending_execution &execution : this->_pending) {
+                    execution.stmt->_error_code = this->_dbh->_error_code;
+                    pgsql_pipeline::fail(execution);
+                }
+                this->_pending.clear();
+                return false;
+            }
+            /* results come back in the order the executions were queued */
+            for (pending_execution &execution : this->_pending) {
+                pgsql_statement &stmt = *execution.stmt;
+                PGresult *res;
+                bool prepare_failed = false;
+                if (execution.sent_prepare) {
+                    res = PQgetResult(conn);
+                    ExecStatusType status = PQresultStatus(res);
+                    if (status != PGRES_COMMAND_OK) {
+                        const char *sqlstate = PQresultErrorField(res, PG_DIAG_SQLSTATE);
+                        pgsql_data_object::pgsql_error(this->_dbh, &stmt, status, sqlstate ? sqlstate : "",
+                                                       res ? PQresultErrorMessage(res) : "", __FILE__, __LINE__);
+                        stmt._is_prepared = false;
+                        prepare_failed = true;
+                    }
+                    PQclear(res);
+                    while ((res = PQgetResult(conn)) != nullptr) {
+                        PQclear(res);
+                    }
+                    if (!execution.sent_execution) {
+                        /* the statement exists on the server unless the prepare failed */
+                        stmt._is_prepared = !prepare_failed;
+                        ok = false;
+                        continue;
+                    }
+                }
+                res = PQgetResult(conn);
+                ExecStatusType status = PQresultStatus(res);
+                if (status == PGRES_PIPELINE_ABORTED) {
+                    if (!prepare_failed) {
+                        pgsql_data_object::pgsql_error(this->_dbh, &stmt, status, "",
+                                                       "pipeline aborted by an earlier error", __FILE__, __LINE__);
+                    }
+                    PQclear(res);
+                    pgsql_pipeline::fail(execution);
+                    ok = false;
+                } else if (status != PGRES_COMMAND_OK && status != PGRES_TUPLES_OK) {
+                    const char *sqlstate = PQresultErrorField(res, PG_DIAG_SQLSTATE);
+                    pgsql_data_object::pgsql_error(this->_dbh, &stmt, status, sqlstate ? sqlstate : "",
+                                                   res ? PQresultErrorMessage(res) : "", __FILE__, __LINE__);
+                    PQclear(res);
+                    pgsql_pipeline::fail(execution);
+                    ok = false;
+                } else if (stmt.receive_pipelined(res)) {
+                    execution.promise.set_value(true);
+                } else {
+                    pgsql_pipeline::fail(execution);
+                    ok = false;
+                }
+                /* each execution ends with a null result */
+                while ((res = PQgetResult(conn)) != nullptr) {
+                    PQclear(res);
+                }
+            }
+            this->_pending.clear();
+            PGresult *res;
+            while ((res = PQgetResult(conn)) != nullptr) {
+                const bool synced = PQresultStatus(res) == PGRES_PIPELINE_SYNC;
+                PQclear(res);
+                if (synced) {
+                    break;
+                }
+            }
+            #endif
+            return ok;
+        }
+
+        void pgsql_pipeline::fail(pending_execution &execution) {
+            execution.stmt->reject(execution.promise, false);
+        }
+
+        ///////////////////////////////////////////////////////////////
+        //                       ASYNC DEFINITIONS                   //
+        ///////////////////////////////////////////////////////////////
+        #ifdef __linux__
+        pgsql_reactor::pgsql_reactor() : _epoll(epoll_create1(EPOLL_CLOEXEC)), _wakeup(eventfd(0, EFD_CLOEXEC)) {
+            epoll_event event{};
+            event.events = EPOLLIN;
+            event.data.fd = this->_wakeup;
+            epoll_ctl(this->_epoll, EPOLL_CTL_ADD, this->_wakeup, &event);
+            this->_thread = std::thread([this]() { this->run(); });
+        }
+
+        pgsql_reactor::~pgsql_reactor() {
+            uint64_t one = 1;
+            if (write(this->_wakeup, &one, sizeof(one)) == sizeof(one)) {
+                this->_thread.join();
+            } else {
+                this->_thread.detach();
+            }
+            close(this->_wakeup);
+            close(this->_epoll);
+        }
+
+        bool pgsql_reactor::watch(PGconn *conn, std::function<void(PGresult *)> on_done) {
+            const int fd = PQsocket(conn);
+            if (fd < 0) {
+                return false;
+            }
+            std::lock_guard<std::mutex> lock(this->_mutex);
+            if (this->_operations.count(fd)) {
+                return false;
+            }
+            this->_operations[fd] = operation{conn, std::move(on_done), nullptr};
+            /* writable until libpq has flushed the query, readable until the results are in */
+            epoll_event event{};
+            event.events = EPOLLIN | EPOLLOUT;
+            event.data.fd = fd;
+            if (epoll_ctl(this->_epoll, EPOLL_CTL_ADD, fd, &event) != 0) {
+                this->_operations.erase(fd);
+                return false;
+            }
+            return true;
+        }
+
+        void pgsql_reactor::run() {
+            epoll_event events[64];
+            for (;;) {
+                int n = epoll_wait(this->_epoll, events, 64, -1);
+                for (int i = 0; i < n; ++i) {
+                    const int fd = events[i].data.fd;
+                    if (fd == this->_wakeup) {
+                        return;
+                    }
+                    operation op;
+                    {
+                        std::lock_guard<std::mutex> lock(this->_mutex);
+                        auto it = this->_operations.find(fd);
+                        if (it == this->_operations.end()) {
+                            continue;
+                        }
+                        /* only this thread touches a watched connection, so the lock is not held while reading */
+                        op = std::move(it->second);
+                        this->_operations.erase(it);
+                    }
+                    if (this->on_event(op, events[i].events)) {
+                        std::lock_guard<std::mutex> lock(this->_mutex);
+                        this->_operations[fd] = std::move(op);
+                        continue;
+                    }
+                    epoll_ctl(this->_epoll, EPOLL_CTL_DEL, fd, nullptr);
+                    op.on_done(op.last);
+                }
+            }
+        }
+
+        bool pgsql_reactor::on_event(operation &op, uint32_t events) {
+            if (events & EPOLLOUT) {
+                const int flushed = PQflush(op.conn);
+                if (flushed < 0) {
+                    PQclear(op.last);
+                    op.last = nullptr;
+                    return false;
+                }
+                if (flushed == 0) {
+                    epoll_event event{};
+                    event.events = EPOLLIN;
+                    event.data.fd = PQsocket(op.conn);
+                    epoll_ctl(this->_epoll, EPOLL_CTL_MOD, event.data.fd, &event);
+                }
+            }
+            if (events & (EPOLLIN | EPOLLERR | EPOLLHUP)) {
+                if (!PQconsumeInput(op.conn)) {
+                    PQclear(op.last);
+                    op.last = nullptr;
+                    return false;
+                }
+                while (!PQisBusy(op.conn)) {
+                    PGresult *res = PQgetResult(op.conn);
+                    if (!res) {
+                        return false;
+                    }
+                    PQclear(op.last);
+                    op.last = res;
+                }
+            }
+            return true;
+        }
+        #endif
+
+        template<typename T>
+        void pgsql_statement::reject(std::promise<T> &promise, T value) {
+            /* the error mode decides between a plain value and an exception in the future */
+            try {
+                data_object::handle_error(*this->_dbh, *this);
+                promise.set_value(std::move(value));
+            } catch (...) {
+                promise.set_exception(std::current_exception());
+            }
+        }
+
+        int pgsql_statement::start_async(std::vector<std::pair<std::string, std::string>> &input_params,
+                                         std::function<void(bool)> done) {
+            #ifdef __linux__
+            PGconn *conn = this->_H->_server;
+            bool sent_prepare;
+            this->_error_code = "000000";
+            PQsetnonblocking(conn, 1);
+            if (!this->send_execution(input_params, false, sent_prepare)) {
+                PQsetnonblocking(conn, 0);
+                return 0;
+            }
+            const bool watched = pgsql_reactor::shared().watch(conn, [this, conn, done](PGresult *res) {
+                PQsetnonblocking(conn, 0);
+                if (!res) {
+                    pgsql_data_object::pgsql_error(this->_H, this, PGRES_FATAL_ERROR, "", "", __FILE__, __LINE__);
+                    done(false);
+                    return;
+                }
+                done(this->receive_pipelined(res) != 0);
+            });
+            if (!watched) {
+                pgsql_data_object::pgsql_error(this->_H, this, PGRES_FATAL_ERROR, "",
+                                               "connection can't be watched for results", __FILE__, __LINE__);
+                PQsetnonblocking(conn, 0);
+                return 0;
+            }
+            return 1;
+            #else
+            return 0;
+            #endif
+        }
+
+        std::future<bool> pgsql_statement::execute_async(std::vector<std::pair<std::string, std::string>> input_params) {
+            #ifdef __linux__
+            if (this->_cursor_name.empty() && this->_streaming == 0) {
+                std::shared_ptr<std::promise<bool>> promise = std::make_shared<std::promise<bool>>();
+                std::future<bool> result = promise->get_future();
+                const int started = this->start_async(input_params, [this, promise](bool ok) {
+                    if (ok) {
+                        promise->set_value(true);
+                    } else {
+                        this->reject(*promise, false);
+                    }
+                });
+                if (!started) {
+                    this->reject(*promise, false);
+                }
+                return result;
+            }
+            #endif
+            return data_object_statement::execute_async(input_params);
+        }
+
+        std::future<wpp::db::result> pgsql_data_object::query_async(std::string query) {
+            #ifdef __linux__
+            /* preparing is local for pgsql; only the execution goes to the server */
+            std::shared_ptr<pgsql_statement> stmt = std::dynamic_pointer_cast<pgsql_statement>(this->prepare(query));
+            if (stmt && stmt->_cursor_name.empty()) {
+                std::shared_ptr<std::promise<wpp::db::result>> promise = std::make_shared<std::promise<wpp::db::result>>();
+                std::future<wpp::db::result> result = promise->get_future();
+                std::vector<std::pair<std::string, std::string>> no_params;
+                pgsql_statement *s = stmt.get();
+                /* the callback keeps the statement alive until its rows are copied out */
+                const int started = s->start_async(no_params, [stmt, promise](bool ok) {
+                    if (ok) {
+                        promise->set_value(stmt->fetch_all());
+                    } else {
+                        stmt->reject(*promise, wpp::db::result());
+                    }
+                });
+                if (!started) {
+                    stmt->reject(*promise, wpp::db::result());
+                }
+                return result;
+            }
+            #endif
+            return data_object::query_async(query);
+        }
+
+        ///////////////////////////////////////////////////////////////
+        //                     COPY READER DEFINITIONS               //
+        ///////////////////////////////////////////////////////////////
+        pgsql_copy_reader::~pgsql_copy_reader() {
+            if (!this->_dbh) {
+                return;
+            }
+            /* a COPY can't be stopped halfway; cancel it and read whatever is left */
+            PGcancel *cancel = PQgetCancel(this->_dbh->_server);
+            if (cancel) {
+                char errbuf[256];
+                PQcancel(cancel, errbuf, sizeof(errbuf));
+                PQfreeCancel(cancel);
+            }
+            PGconn *conn = this->_dbh->_server;
+            this->_dbh = nullptr;
+            this->release_chunk();
+            while (PQgetCopyData(conn, &this->_chunk, 0) > 0) {
+                this->release_chunk();
+            }
+            /* no error handling here: the cancellation error is expected */
+            PGresult *res;
+            while ((res = PQgetResult(conn)) != nullptr) {
+                PQclear(res);
+            }
+        }
+
+        bool pgsql_copy_reader::next(boost::string_view &chunk) {
+            this->release_chunk();
+            if (!this->_dbh) {
+                return false;
+            }
+            int size = PQgetCopyData(this->_dbh->_server, &this->_chunk, 0);
+            if (size > 0) {
+                chunk = boost::string_view(this->_chunk, (size_t) size);
+                return true;
+            }
+            this->_chunk = nullptr;
+            if (size == -2) {
+                pgsql_data_object *dbh = this->_dbh;
+                this->_dbh = nullptr;
+                pgsql_data_object::pgsql_error(dbh, nullptr, PGRES_FATAL_ERROR, "", "", __FILE__, __LINE__);
+                data_object::handle_error(*dbh);
+                return false;
+            }
+            /* -1: the copy is done and the final result has the status */
+            this->finish();
+            return false;
+        }
+
+        row_view pgsql_copy_reader::next_row() {
+            boost::string_view chunk;
+            if (this->_format != COPY_TEXT || !this->next(chunk)) {
+                return row_view();
+            }
+            if (!chunk.empty() && chunk.back() == '\n') {
+                chunk.remove_suffix(1);
+            }
+            /* unescaping never grows the text, so the views stay valid while we append */
+            this->_unescaped.clear();
+            this->_unescaped.reserve(chunk.size());
+            this->_fields.clear();
+            size_t field_begin = 0;
+            bool null_field = false;
+            for (size_t i = 0; i <= chunk.size(); ++i) {
+                if (i == chunk.size() || chunk[i] == '\t') {
+                    if (null_field) {
+                        this->_fields.emplace_back();
+                    } else {
+                        this->_fields.emplace_back(this->_unescaped.data() + field_begin,
+                                                   this->_unescaped.size() - field_begin);
+                    }
+                    field_begin = this->_unescaped.size();
+                    null_field = false;
+                } else if (chunk[i] == '\\' && i + 1 < chunk.size()) {
+                    switch (chunk[++i]) {
+                        case 'N':
+                            null_field = true;
+                            break;
+                        case 't':
+                            this->_unescaped += '\t';
+                            break;
+                        case 'n':
+                            this->_unescaped += '\n';
+                            break;
+                        case 'r':
+                            this->_unescaped += '\r';
+                            break;
+                        case 'b':
+                            this->_unescaped += '\b';
+                            break;
+                        case 'f':
+                            this->_unescaped += '\f';
+                            break;
+                        case 'v':
+                            this->_unescaped += '\v';
+                            break;
+                        default:
+                            this->_unescaped += chunk[i];
+                    }
+                } else {
+                    this->_unescaped += chunk[i];
+                }
+            }
+            return row_view(this->_fields.data(), this->_fields.size(), &this->_schema);
+        }
+
+        int pgsql_copy_reader::finish() {
+            pgsql_data_object *dbh = this->_dbh;
+            this->_dbh = nullptr;
+            int ok = 1;
+            PGresult *res;
+            while ((res = PQgetResult(dbh->_server)) != nullptr) {
+                ExecStatusType status = PQresultStatus(res);
+                if (status == PGRES_COMMAND_OK) {
+                    this->_row_count = std::atol(PQcmdTuples(res));
+                } else {
+                    const char *sqlstate = PQresultErrorField(res, PG_DIAG_SQLSTATE);
+                    pgsql_data_object::pgsql_error(dbh, nullptr, status, sqlstate ? sqlstate : "", "",
+                                                   __FILE__, __LINE__);
+                    ok = 0;
+                }
+                PQclear(res);
+            }
+            if (!ok) {
+                data_object::handle_error(*dbh);
+            }
+            return ok;
+        }
+
+        void pgsql_copy_reader::release_chunk() {
+            if (this->_chunk) {
+                PQfreemem(this->_chunk);
+                this->_chunk = nullptr;
+            }
+        }
+
+        ///////////////////////////////////////////////////////////////
+        //                     COPY WRITER DEFINITIONS               //
+        ///////////////////////////////////////////////////////////////
+        pgsql_copy_writer::pgsql_copy_writer(pgsql_data_object *dbh, copy_format format) :
+                _dbh(dbh), _format(format) {
+            this->_buffer.reserve(chunk_size + 1024);
+            if (format == COPY_BINARY) {
+                /* signature, flags and header extension length */
+                this->_buffer.append("PGCOPY\n\377\r\n\0", 11);
+                this->put_uint(0, 4);
+                this->put_uint(0, 4);
+            }
+        }
+
+        template<typename... Ts>
+        bool pgsql_copy_writer::write_row(const Ts &... values) {
+            if (!this->_dbh) {
+                return false;
+            }
+            this->begin_row(sizeof...(Ts));
+            int expand[] = {0, (this->separator(), this->put(values), 0)...};
+            (void) expand;
+            return this->end_row();
+        }
+
+        template<typename... Ts>
+        bool pgsql_copy_writer::write_row(const std::tuple<Ts...> &values) {
+            return this->write_tuple(values, std::index_sequence_for<Ts...>());
+        }
+
+        template<size_t... I, typename... Ts>
+        bool pgsql_copy_writer::write_tuple(const std::tuple<Ts...> &values, std::index_sequence<I...>) {
+            return this->write_row(std::get<I>(values)...);
+        }
+
+        bool pgsql_copy_writer::write_columns(const std::vector<batch_column> &columns) {
+            const size_t rows = columns.empty() ? 0 : columns[0].size();
+            for (const batch_column &column : columns) {
+                if (column.size() != rows) {
+                    data_object::raise_impl_error(this->_dbh, nullptr, "HY093", "batch columns have different sizes");
+                    return this->fail();
+                }
+            }
+            for (size_t row = 0; row < rows && this->_dbh; ++row) {
+                this->begin_row(columns.size());
+                for (const batch_column &column : columns) {
+                    this->separator();
+                    switch (column.type()) {
+                        case PARAM_INT:
+                            this->put_int(column.get_int(row));
+                            break;
+                        case PARAM_FLOAT:
+                            this->put_real(column.get_real(row));
+                            break;
+                        default:
+                            this->put(column.get_string(row));
+                    }
+                }
+                if (!this->end_row()) {
+                    return false;
+                }
+            }
+            return this->_dbh != nullptr;
+        }
+
+        bool pgsql_copy_writer::write_columns(const columnar_result &columns) {
+            for (size_t row = 0; row < columns.size() && this->_dbh; ++row) {
+                this->begin_row(columns.columns());
+                for (size_t col = 0; col < columns.columns(); ++col) {
+                    const columnar_result::column &column = columns.get_column(col);
+                    this->separator();
+                    if (column.is_null(row)) {
+                        this->put(nullptr);
+                        continue;
+                    }
+                    switch (column.type()) {
+                        case INTEGER:
+                            this->put_int(column.get_int(row));
+                            break;
+                        case REAL:
+                            this->put_real(column.get_real(row));
+                            break;
+                        case BOOLEAN:
+                            this->put(column.get_bool(row));
+                            break;
+                        default:
+                            this->put(column.get_text(row));
+                    }
+                }
+                if (!this->end_row()) {
+                    return false;
+                }
+            }
+            return this->_dbh != nullptr;
+        }
+
+        long pgsql_copy_writer::end() {
+            if (!this->_dbh) {
+                return -1;
+            }
+            if (this->_format == COPY_BINARY) {
+                this->put_uint(0xffff, 2);
+            }
+            if (!this->flush(true)) {
+                return -1;
+            }
+            pgsql_data_object *dbh = this->_dbh;
+            this->_dbh = nullptr;
+            if (PQputCopyEnd(dbh->_server, nullptr) != 1) {
+                pgsql_data_object::pgsql_error(dbh, nullptr, PGRES_FATAL_ERROR, "", "", __FILE__, __LINE__);
+                data_object::handle_error(*dbh);
+                return -1;
+            }
+            /* the server only reports bad rows now */
+            long rows = -1;
+            PGresult *res;
+            while ((res = PQgetResult(dbh->_server)) != nullptr) {
+                ExecStatusType status = PQresultStatus(res);
+                if (status == PGRES_COMMAND_OK) {
+                    rows = std::atol(PQcmdTuples(res));
+                } else {
+                    const char *sqlstate = PQresultErrorField(res, PG_DIAG_SQLSTATE);
+                    pgsql_data_object::pgsql_error(dbh, nullptr, status, sqlstate ? sqlstate : "", "",
+                                                   __FILE__, __LINE__);
+                    rows = -1;
+                }
+                PQclear(res);
+            }
+            if (rows < 0) {
+                data_object::handle_error(*dbh);
+            }
+            return rows;
+        }
+
+        bool pgsql_copy_writer::abort(const std::string &reason) {
+            if (!this->_dbh) {
+                return false;
+            }
+            pgsql_data_object *dbh = this->_dbh;
+            this->_dbh = nullptr;
+            this->_buffer.clear();
+            if (PQputCopyEnd(dbh->_server, reason.c_str()) != 1) {
+                return false;
+            }
+            PGresult *res;
+            while ((res = PQgetResult(dbh->_server)) != nullptr) {
+                PQclear(res);
+            }
+            return true;
+        }
+
+        void pgsql_copy_writer::begin_row(size_t fields) {
+            this->_first_field = true;
+            if (this->_format == COPY_BINARY) {
+                this->put_uint(fields, 2);
+            }
+        }
+
+        bool pgsql_copy_writer::end_row() {
+            if (this->_format == COPY_TEXT) {
+                this->_buffer += '\n';
+            }
+            return this->flush(false);
+        }
+
+        void pgsql_copy_writer::separator() {
+            if (!this->_first_field && this->_format == COPY_TEXT) {
+                this->_buffer += '\t';
+            }
+            this->_first_field = false;
+        }
+
+        void pgsql_copy_writer::put(std::nullptr_t) {
+            if (this->_format == COPY_BINARY) {
+                this->put_uint(0xffffffff, 4);
+            } else {
+                this->_buffer.append("\\N", 2);
+            }
+        }
+
+        void pgsql_copy_writer::put(bool value) {
+            if (this->_format == COPY_BINARY) {
+                this->put_uint(1, 4);
+                this->_buffer += (char) value;
+            } else {
+                this->_buffer += value ? 't' : 'f';
+            }
+        }
+
+        void pgsql_copy_writer::put_int(int64_t value) {
+            if (this->_format == COPY_BINARY) {
+                this->put_uint(8, 4);
+                this->put_uint((uint64_t) value, 8);
+            } else {
+                char buf[24];
+                int len = std::snprintf(buf, sizeof(buf), "%lld", (long long) value);
+                this->_buffer.append(buf, len);
+            }
+        }
+
+        void pgsql_copy_writer::put_real(double value) {
+            if (this->_format == COPY_BINARY) {
+                uint64_t bits;
+                std::memcpy(&bits, &value, sizeof(bits));
+                this->put_uint(8, 4);
+                this->put_uint(bits, 8);
+            } else if (value != value) {
+                this->_buffer.append("NaN");
+            } else if (value > std::numeric_limits<double>::max() || value < -std::numeric_limits<double>::max()) {
+                this->_buffer.append(value > 0 ? "Infinity" : "-Infinity");
+            } else {
+                char buf[32];
+                int len = std::snprintf(buf, sizeof(buf), "%.17g", value);
+                this->_buffer.append(buf, len);
+            }
+        }
+
+        void pgsql_copy_writer::put_text(const char *data, size_t size) {
+            if (this->_format == COPY_BINARY) {
+                this->put_uint(size, 4);
+                this->_buffer.append(data, size);
+                return;
+            }
+            /* text format: backslash, tab and line breaks must be escaped */
+            const char *end = data + size;
+            const char *begin = data;
+            for (const char *c = data; c != end; ++c) {
+                const char *escaped = nullptr;
+                switch (*c) {
+                    case '\\':
+                        escaped = "\\\\";
+                        break;
+                    case '\t':
+                        escaped = "\\t";
+                        break;
+                    case '\n':
+                        escaped = "\\n";
+                        break;
+                    case '\r':
+                        escaped = "\\r";
+                        break;
+                    default:
+                        continue;
+                }
+                this->_buffer.append(begin, c - begin);
+                this->_buffer.append(escaped, 2);
+                begin = c + 1;
+            }
+            this->_buffer.append(begin, end - begin);
+        }
+
+        void pgsql_copy_writer::put_uint(uint64_t value, int bytes) {
+            /* network byte order */
+            for (int shift = (bytes - 1) * 8; shift >= 0; shift -= 8) {
+                this->_buffer += (char) ((value >> shift) & 0xff);
+            }
+        }
+
+        bool pgsql_copy_writer::flush(bool force) {
+            if (!this->_dbh) {
+                return false;
+            }
+            if (this->_buffer.empty() || (!force && this->_buffer.size() < chunk_size)) {
+                return true;
+            }
+            /* blocks while the server is behind, which is all the backpressure we need */
+            if (PQputCopyData(this->_dbh->_server, this->_buffer.data(), (int) this->_buffer.size()) != 1) {
+                pgsql_data_object::pgsql_error(this->_dbh, nullptr, PGRES_FATAL_ERROR, "", "", __FILE__, __LINE__);
+                return this->fail();
+            }
+            this->_buffer.clear();
+            return true;
+        }
+
+        bool pgsql_copy_writer::fail() {
+            pgsql_data_object *dbh = this->_dbh;
+            this->abort();
+            if (dbh) {
+                data_object::handle_error(*dbh);
+            }
+            return false;
+        }
+
         ///////////////////////////////////////////////////////////////
         //                 TYPE ALIAS WITHOUT TEMPLATE               //
         ///////////////////////////////////////////////////////////////
@@ -15,6 +15,35 @@ namespace wpp {
         ///////////////////////////////////////////////////////////////
         class sqlite_data_object;
 
+        // Connection options, applied when the database is opened. A pragma that fails (or that the
+        // database does not take, as WAL on :memory:) fails the connection instead of being ignored
+        enum sqlite_attribute_type {
+            // PRAGMA journal_mode: "DELETE", "TRUNCATE", "PERSIST", "MEMORY", "WAL" or "OFF"
+            SQLITE_ATTR_JOURNAL_MODE = attribute_type::ATTR_DRIVER_SPECIFIC,
+            // PRAGMA synchronous: "OFF", "NORMAL", "FULL", "EXTRA" or 0 to 3
+            SQLITE_ATTR_SYNCHRONOUS,
+            // PRAGMA mmap_size: bytes of the file mapped into memory (a string for more than 2GB)
+            SQLITE_ATTR_MMAP_SIZE,
+            // PRAGMA cache_size: pages, or KiB when negative
+            SQLITE_ATTR_CACHE_SIZE,
+            // PRAGMA temp_store: "DEFAULT", "FILE", "MEMORY" or 0 to 2
+            SQLITE_ATTR_TEMP_STORE,
+            // PRAGMA page_size: only new databases take it, so it is set before the journal mode
+            SQLITE_ATTR_PAGE_SIZE,
+            // SQLITE_OPEN_NOMUTEX or SQLITE_OPEN_FULLMUTEX, one of sqlite_threading_mode
+            SQLITE_ATTR_THREADING_MODE,
+            // SQLITE_OPEN_READONLY instead of SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE
+            SQLITE_ATTR_READ_ONLY,
+        };
+        enum sqlite_threading_mode {
+            // whatever the library was compiled or configured with
+            SQLITE_THREADING_DEFAULT,
+            // no mutexes: the connection is used by one thread at a time (NOMUTEX)
+            SQLITE_THREADING_MULTI_THREAD,
+            // every call on the connection is serialized (FULLMUTEX)
+            SQLITE_THREADING_SERIALIZED
+        };
+
         struct sqlite_error_info {
             const char *file;
             int line;
@@ -33,33 +62,198 @@ namespace wpp {
                     }
                 }
 
+                // True if the statement does not write to the database (sqlite3_stmt_readonly)
+                bool read_only() const { return this->_stmt && sqlite3_stmt_readonly(this->_stmt); }
+
                 virtual int executer() override;
 
+                virtual int batch_executer(const std::vector<batch_column> &columns, size_t rows) override;
+
                 virtual int fetcher(fetch_orientation ori, long offset) override;
 
                 virtual int describer(int colno) override;
 
                 virtual int get_col(int colno, std::string &ptr, int &caller_frees) override;
 
+                virtual int col_is_null(int colno) override;
+
+                virtual int get_col_view(int colno, field_view &value) override;
+
                 virtual int param_hook(bound_param_data &attr, param_event val) override;
 
                 virtual int get_column_meta(long colno, column_data &return_value) override;
 
                 virtual int cursor_closer() override;
 
+                virtual int resetter() override;
+
             private:
+                // Column type from the declared type (or the current value for expressions)
+                param_type declared_param_type(int colno);
+
                 sqlite_data_object *_H;
                 sqlite3_stmt *_stmt;
                 unsigned _pre_fetched:1;
                 unsigned _done:1;
         };
 
+        // An open BLOB, read or written in place with sqlite3_blob_read/sqlite3_blob_write.
+        // It must not outlive its connection
+        class sqlite_blob {
+            public:
+                sqlite_blob() = default;
+
+                sqlite_blob(const sqlite_blob &) = delete;
+
+                sqlite_blob(sqlite_blob &&other) noexcept { *this = std::move(other); }
+
+                sqlite_blob &operator=(sqlite_blob &&other) noexcept {
+                    std::swap(_dbh, other._dbh);
+                    std::swap(_blob, other._blob);
+                    std::swap(_size, other._size);
+                    std::swap(_offset, other._offset);
+                    return *this;
+                }
+
+                ~sqlite_blob() { this->close(); }
+
+                explicit operator bool() const noexcept { return this->_blob != nullptr; }
+
+                // Size of the BLOB, fixed when the row was written (e.g. with zeroblob(n))
+                size_t size() const noexcept { return this->_size; }
+
+                // Position of the next read or write
+                size_t tell() const noexcept { return this->_offset; }
+
+                bool seek(size_t offset);
+
+                // Move to the same column of another row, without opening the table again
+                bool reopen(int64_t rowid);
+
+                void close();
+
+            protected:
+                sqlite_blob(sqlite_data_object *dbh, sqlite3_blob *blob) : _dbh(dbh), _blob(blob) {
+                    this->_size = (size_t) sqlite3_blob_bytes(blob);
+                }
+
+                bool fail();
+
+                sqlite_data_object *_dbh{nullptr};
+                sqlite3_blob *_blob{nullptr};
+                size_t _size{0};
+                size_t _offset{0};
+        };
+
+        // Reads a BLOB in chunks, so that it never has to be in memory as a whole
+        class sqlite_blob_reader
+                : public sqlite_blob {
+            public:
+                friend sqlite_data_object;
+
+                sqlite_blob_reader() = default;
+
+                // Up to n bytes into buffer; returns the number of bytes read (0 at the end) or -1
+                long read(char *buffer, size_t n);
+
+                // Replaces chunk with the next (up to) n bytes; false at the end or on error
+                bool read(std::string &chunk, size_t n = chunk_size);
+
+                static constexpr size_t chunk_size = 64 * 1024;
+
+            protected:
+                sqlite_blob_reader(sqlite_data_object *dbh, sqlite3_blob *blob) : sqlite_blob(dbh, blob) {}
+        };
+
+        // Writes a BLOB in chunks. Writes cannot change its size, so create the row with zeroblob(n) first
+        class sqlite_blob_writer
+                : public sqlite_blob {
+            public:
+                friend sqlite_data_object;
+
+                sqlite_blob_writer() = default;
+
+                bool write(const char *data, size_t n);
+
+                bool write(boost::string_view data) { return this->write(data.data(), data.size()); }
+
+            protected:
+                sqlite_blob_writer(sqlite_data_object *dbh, sqlite3_blob *blob) : sqlite_blob(dbh, blob) {}
+        };
+
+        // Online backup with sqlite3_backup_step. Pages are copied a few at a time and the source is only
+        // locked during a step, so writers keep going in between. It must not outlive its connections
+        class sqlite_backup {
+            public:
+                friend sqlite_data_object;
+
+                sqlite_backup() = default;
+
+                sqlite_backup(const sqlite_backup &) = delete;
+
+                sqlite_backup(sqlite_backup &&other) noexcept { *this = std::move(other); }
+
+                sqlite_backup &operator=(sqlite_backup &&other) noexcept {
+                    std::swap(_dbh, other._dbh);
+                    std::swap(_backup, other._backup);
+                    std::swap(_dest, other._dest);
+                    std::swap(_file, other._file);
+                    std::swap(_done, other._done);
+                    std::swap(_failed, other._failed);
+                    return *this;
+                }
+
+                ~sqlite_backup() { this->close(); }
+
+                explicit operator bool() const noexcept { return this->_backup != nullptr; }
+
+                // Copy up to pages pages (the rest if negative); true while there is something left to copy
+                bool step(int pages = step_pages);
+
+                // Every page was copied
+                bool done() const noexcept { return this->_done; }
+
+                // Pages left and pages of the source, as of the last step
+                int remaining() const { return this->_backup ? sqlite3_backup_remaining(this->_backup) : 0; }
+
+                int page_count() const { return this->_backup ? sqlite3_backup_pagecount(this->_backup) : 0; }
+
+                // Release the backup; false if a step failed. Finishing before done() leaves the destination as it was
+                bool finish();
+
+                static constexpr int step_pages = 256;
+
+            protected:
+                sqlite_backup(sqlite_data_object *dbh, sqlite3_backup *backup, sqlite3 *dest, sqlite3 *file)
+                        : _dbh(dbh), _backup(backup), _dest(dest), _file(file) {}
+
+                void close();
+
+                bool fail();
+
+                // errors are raised on the data object the backup was started from
+                sqlite_data_object *_dbh{nullptr};
+                sqlite3_backup *_backup{nullptr};
+                // the destination connection holds the error of a step
+                sqlite3 *_dest{nullptr};
+                // connection to the file given by path, owned by the backup
+                sqlite3 *_file{nullptr};
+                bool _done{false};
+                bool _failed{false};
+        };
+
         class sqlite_data_object
                 : public data_object_crtp<sqlite_data_object, sqlite_statement> {
             public:
                 friend class sqlite_statement;
 
-                sqlite_data_object(std::string data_source = ":memory:",
+                friend class sqlite_blob;
+
+                friend class sqlite_blob_writer;
+
+                friend class sqlite_backup;
+
+                sqlite_data_object(std::string data_source = "sqlite::memory:",
                                    std::string username = "",
                                    std::string passwd = "",
                                    std::unordered_map<attribute_type, driver_option> options = {}) :
@@ -69,6 +263,8 @@ namespace wpp {
 
                 ~sqlite_data_object() {
                     sqlite_error_info *einfo = &this->_einfo;
+                    /* statements must be finalized before the database is closed */
+                    this->_statement_cache.clear();
                     if (this->_db) {
                         #ifdef HAVE_SQLITE3_CLOSE_V2
                         sqlite3_close_v2(this->_db);
@@ -159,6 +355,12 @@ namespace wpp {
                         case ATTR_TIMEOUT:
                             sqlite3_busy_timeout(this->_db, (val.get_int()) * 1000);
                             return 1;
+                        case SQLITE_ATTR_JOURNAL_MODE:
+                        case SQLITE_ATTR_SYNCHRONOUS:
+                        case SQLITE_ATTR_MMAP_SIZE:
+                        case SQLITE_ATTR_CACHE_SIZE:
+                        case SQLITE_ATTR_TEMP_STORE:
+                            return this->apply_pragma(attr, val);
                     }
                     return 0;
                 }
@@ -167,6 +369,16 @@ namespace wpp {
                     return std::to_string(sqlite3_last_insert_rowid(this->_db));
                 }
 
+                // an open database file does not go away like a server connection
+                virtual int check_liveness() override {
+                    return this->_db != nullptr;
+                }
+
+                // also sees transactions opened with a plain "BEGIN" statement
+                virtual int in_transaction_func() override {
+                    return this->_db && !sqlite3_get_autocommit(this->_db);
+                }
+
                 virtual int fetch_err(const data_object_statement *stmt, std::vector<std::string> &info) override {
                     sqlite_error_info *einfo = &this->_einfo;
                     if (einfo->errcode) {
@@ -184,15 +396,73 @@ namespace wpp {
                         case ATTR_SERVER_VERSION:
                             val = std::string(sqlite3_libversion());
                             break;
+                        case SQLITE_ATTR_JOURNAL_MODE:
+                        case SQLITE_ATTR_SYNCHRONOUS:
+                        case SQLITE_ATTR_MMAP_SIZE:
+                        case SQLITE_ATTR_CACHE_SIZE:
+                        case SQLITE_ATTR_TEMP_STORE:
+                        case SQLITE_ATTR_PAGE_SIZE: {
+                            std::string value;
+                            if (!this->run_pragma(std::string("PRAGMA ") + pragma_name(attr), &value)) {
+                                return 0;
+                            }
+                            val = value;
+                            break;
+                        }
+                        case SQLITE_ATTR_READ_ONLY:
+                            val = sqlite3_db_readonly(this->_db, "main") == 1;
+                            break;
                         default:
                             return 0;
                     }
                     return 1;
                 }
 
+                // Open the BLOB in table.column of rowid. database is "main", "temp" or an attached name
+                sqlite_blob_reader blob_reader(const std::string &table, const std::string &column, int64_t rowid,
+                                               const std::string &database = "main");
+
+                sqlite_blob_writer blob_writer(const std::string &table, const std::string &column, int64_t rowid,
+                                               const std::string &database = "main");
+
+                // The database as an image in the SQLite file format (sqlite3_serialize)
+                bool snapshot(std::string &image, const std::string &database = "main");
+
+                // Replace the database with an image from snapshot() or a database file (sqlite3_deserialize).
+                // The database is in memory from then on, whatever it was opened from
+                bool restore(boost::string_view image, const std::string &database = "main");
+
+                // Online backup of the database into the file at path, which is created or replaced
+                sqlite_backup backup_to(const std::string &path, const std::string &database = "main");
+
+                sqlite_backup backup_to(sqlite_data_object &destination, const std::string &database = "main",
+                                        const std::string &destination_database = "main");
+
+                // Replace the database with the database file at path, e.g. to warm up a :memory: database
+                sqlite_backup restore_from(const std::string &path, const std::string &database = "main");
+
             protected:
+                static const char *pragma_name(long attr);
+
+                // "PRAGMA ...", with the first column of the result in value if it has one
+                bool run_pragma(const std::string &pragma, std::string *value);
+
+                // Set the pragma of attr and check that the database took the value
+                int apply_pragma(long attr, const driver_option &val);
+
+                sqlite3_blob *open_blob(const std::string &database, const std::string &table,
+                                        const std::string &column, int64_t rowid, bool writable);
+
+                // Connection to a database file for backup_to and restore_from; null on failure
+                sqlite3 *open_file(const std::string &path, int flags);
+
+                sqlite_backup start_backup(sqlite3 *dest, const std::string &dest_name, sqlite3 *source,
+                                           const std::string &source_name, sqlite3 *file);
+
                 sqlite3 *_db;
                 sqlite_error_info _einfo;
+                // copy of the last message, so a later ROLLBACK doesn't overwrite it
+                std::string _errmsg;
 
                 static int sqlite_error(sqlite_data_object *dbh, sqlite_statement *stmt, const char *file, int line);
         };
@@ -223,6 +493,61 @@ namespace wpp {
             }
         }
 
+        int sqlite_statement::batch_executer(const std::vector<batch_column> &columns, size_t rows) {
+            sqlite3 *db = this->_H->_db;
+            if (this->_executed && !this->_done) {
+                sqlite3_reset(this->_stmt);
+            }
+            /* outside a transaction every step would be its own commit (and fsync) */
+            const bool implicit_transaction = sqlite3_get_autocommit(db) != 0;
+            if (implicit_transaction && sqlite3_exec(db, "BEGIN", nullptr, nullptr, nullptr) != SQLITE_OK) {
+                sqlite_data_object::sqlite_error(this->_H, this, __FILE__, __LINE__);
+                return 0;
+            }
+            long changes = 0;
+            for (size_t row = 0; row < rows; ++row) {
+                int rc = SQLITE_OK;
+                for (size_t col = 0; col < columns.size() && rc == SQLITE_OK; ++col) {
+                    const int index = (int) col + 1;
+                    switch (columns[col].type()) {
+                        case PARAM_INT:
+                            rc = sqlite3_bind_int64(this->_stmt, index, columns[col].get_int(row));
+                            break;
+                        case PARAM_FLOAT:
+                            rc = sqlite3_bind_double(this->_stmt, index, columns[col].get_real(row));
+                            break;
+                        default: {
+                            const std::string &value = columns[col].get_string(row);
+                            rc = sqlite3_bind_text(this->_stmt, index, value.data(), value.size(), SQLITE_STATIC);
+                        }
+                    }
+                }
+                if (rc == SQLITE_OK) {
+                    rc = sqlite3_step(this->_stmt);
+                }
+                if (rc != SQLITE_DONE && rc != SQLITE_ROW) {
+                    sqlite_data_object::sqlite_error(this->_H, this, __FILE__, __LINE__);
+                    sqlite3_reset(this->_stmt);
+                    if (implicit_transaction) {
+                        sqlite3_exec(db, "ROLLBACK", nullptr, nullptr, nullptr);
+                    }
+                    return 0;
+                }
+                changes += sqlite3_changes(db);
+                sqlite3_reset(this->_stmt);
+            }
+            /* the strings bound as SQLITE_STATIC belong to the caller */
+            sqlite3_clear_bindings(this->_stmt);
+            if (implicit_transaction && sqlite3_exec(db, "COMMIT", nullptr, nullptr, nullptr) != SQLITE_OK) {
+                sqlite_data_object::sqlite_error(this->_H, this, __FILE__, __LINE__);
+                sqlite3_exec(db, "ROLLBACK", nullptr, nullptr, nullptr);
+                return 0;
+            }
+            this->_row_count = changes;
+            this->_done = 1;
+            return 1;
+        }
+
         int
         sqlite_data_object::sqlite_error(sqlite_data_object *dbh, sqlite_statement *stmt, const char *file, int line) {
             std::string &pdo_err = stmt ? stmt->_error_code : dbh->_error_code;
@@ -231,7 +556,8 @@ namespace wpp {
             einfo.file = file;
             einfo.line = line;
             if (einfo.errcode != SQLITE_OK) {
-                einfo.errmsg = (char *) sqlite3_errmsg(dbh->_db);
+                dbh->_errmsg = sqlite3_errmsg(dbh->_db);
+                einfo.errmsg = (char *) dbh->_errmsg.c_str();
             } else { /* no error */
                 pdo_err = "000000";
                 return 0;
@@ -298,17 +624,44 @@ namespace wpp {
             this->_columns[colno].name = str;
             this->_columns[colno].maxlen = 0xffffffff;
             this->_columns[colno].precision = 0;
+            this->_columns[colno].param_type = declared_param_type(colno);
+            return 1;
+        }
+
+        param_type sqlite_statement::declared_param_type(int colno) {
+            /* table columns: the affinity rules of https://www.sqlite.org/datatype3.html, in their order */
+            const char *declared = sqlite3_column_decltype(this->_stmt, colno);
+            if (declared) {
+                std::string type = boost::algorithm::to_upper_copy(std::string(declared));
+                if (type.find("INT") != std::string::npos) {
+                    return PARAM_INT;
+                } else if (type.find("CHAR") != std::string::npos || type.find("CLOB") != std::string::npos ||
+                           type.find("TEXT") != std::string::npos) {
+                    return PARAM_STR;
+                } else if (type.empty() || type.find("BLOB") != std::string::npos) {
+                    return PARAM_LOB;
+                } else if (type.find("REAL") != std::string::npos || type.find("FLOA") != std::string::npos ||
+                           type.find("DOUB") != std::string::npos) {
+                    return PARAM_FLOAT;
+                } else if (type.find("BOOL") != std::string::npos) {
+                    return PARAM_BOOL;
+                }
+                /* NUMERIC affinity holds integers or reals: the value decides */
+            }
+            /* expressions have no declared type: use the type of the value in the current row */
+            if (colno >= sqlite3_data_count(this->_stmt)) {
+                return PARAM_STR;
+            }
             switch (sqlite3_column_type(this->_stmt, colno)) {
                 case SQLITE_INTEGER:
+                    return PARAM_INT;
                 case SQLITE_FLOAT:
-                case SQLITE3_TEXT:
+                    return PARAM_FLOAT;
                 case SQLITE_BLOB:
-                case SQLITE_NULL:
+                    return PARAM_LOB;
                 default:
-                    this->_columns[colno].param_type = PARAM_STR;
-                    break;
+                    return PARAM_STR;
             }
-            return 1;
         }
 
         int sqlite_statement::get_col(int colno, std::string &result, int &caller_frees) {
@@ -326,8 +679,20 @@ namespace wpp {
                     result = "";
                     return 1;
                 case SQLITE_BLOB:
+                    /* blobs hold zeros: the length comes from sqlite3_column_bytes, after sqlite3_column_blob */
                     char_result = (char *) sqlite3_column_blob(this->_stmt, colno);
-                    result = char_result;
+                    result.assign(char_result ? char_result : "", sqlite3_column_bytes(this->_stmt, colno));
+                    return 1;
+                case SQLITE_INTEGER:
+                    /* read the number itself rather than having sqlite print it */
+                    if (this->_columns[colno].param_type == PARAM_BOOL) {
+                        result = sqlite3_column_int64(this->_stmt, colno) ? "true" : "false";
+                    } else {
+                        result = std::to_string((int64_t) sqlite3_column_int64(this->_stmt, colno));
+                    }
+                    return 1;
+                case SQLITE_FLOAT:
+                    result = field_view::format_real(sqlite3_column_double(this->_stmt, colno));
                     return 1;
                 default:
                     char_result = (char *) sqlite3_column_text(this->_stmt, colno);
@@ -336,6 +701,45 @@ namespace wpp {
             }
         }
 
+        int sqlite_statement::col_is_null(int colno) {
+            return this->_stmt && sqlite3_column_type(this->_stmt, colno) == SQLITE_NULL;
+        }
+
+        int sqlite_statement::get_col_view(int colno, field_view &value) {
+            if (!this->_stmt) {
+                return 0;
+            }
+            if (colno >= sqlite3_data_count(this->_stmt)) {
+                sqlite_data_object::sqlite_error(this->_H, this, __FILE__, __LINE__);
+                return 0;
+            }
+            switch (sqlite3_column_type(this->_stmt, colno)) {
+                case SQLITE_NULL:
+                    value = field_view();
+                    return 1;
+                case SQLITE_INTEGER:
+                    /* BOOLEAN columns store 0 and 1 */
+                    if (this->_columns[colno].param_type == PARAM_BOOL) {
+                        value = field_view(sqlite3_column_int64(this->_stmt, colno) != 0);
+                    } else {
+                        value = field_view((int64_t) sqlite3_column_int64(this->_stmt, colno));
+                    }
+                    return 1;
+                case SQLITE_FLOAT:
+                    value = field_view(sqlite3_column_double(this->_stmt, colno));
+                    return 1;
+                case SQLITE_BLOB:
+                    value = field_view((const char *) sqlite3_column_blob(this->_stmt, colno),
+                                       sqlite3_column_bytes(this->_stmt, colno));
+                    return 1;
+                default:
+                    /* sqlite3_column_text before sqlite3_column_bytes, so the length is that of the text */
+                    const char *text = (const char *) sqlite3_column_text(this->_stmt, colno);
+                    value = field_view(text, sqlite3_column_bytes(this->_stmt, colno));
+                    return 1;
+            }
+        }
+
         int sqlite_statement::param_hook(bound_param_data &param, param_event event_type) {
             switch (event_type) {
                 case PARAM_EVT_EXEC_PRE:
@@ -356,24 +760,29 @@ namespace wpp {
                                 return 0;
                             case PARAM_INT:
                             case PARAM_BOOL:
-                                if (std::numeric_limits<long>::max() > 2147483647) {
-                                    if (SQLITE_OK ==
-                                        sqlite3_bind_int64(this->_stmt, param.paramno + 1, *(long *) param.parameter)) {
-                                        return 1;
-                                    }
-                                } else {
-                                    if (SQLITE_OK ==
-                                        sqlite3_bind_int(this->_stmt, param.paramno + 1, *(long *) param.parameter)) {
+                                if (param_exceeds_int64(param)) {
+                                    /* bound as its exact text, as a string holding it would be */
+                                    const std::string text = byte_to_string(param.parameter_tag, param.parameter);
+                                    if (SQLITE_OK == sqlite3_bind_text(this->_stmt, param.paramno + 1, text.c_str(),
+                                                                       text.size(), SQLITE_TRANSIENT)) {
                                         return 1;
                                     }
+                                    sqlite_data_object::sqlite_error(this->_H, this, __FILE__, __LINE__);
+                                    return 0;
+                                }
+                                /* read with the type it was bound with: a bound int is not a long */
+                                if (SQLITE_OK == sqlite3_bind_int64(this->_stmt, param.paramno + 1,
+                                                                    param_as<sqlite3_int64>(param))) {
+                                    return 1;
                                 }
                                 sqlite_data_object::sqlite_error(this->_H, this, __FILE__, __LINE__);
                                 return 0;
                             case PARAM_FLOAT:
                                 if (SQLITE_OK ==
-                                    sqlite3_bind_double(this->_stmt, param.paramno + 1, *(double *) param.parameter)) {
+                                    sqlite3_bind_double(this->_stmt, param.paramno + 1, param_as<double>(param))) {
                                     return 1;
                                 }
+                                sqlite_data_object::sqlite_error(this->_H, this, __FILE__, __LINE__);
                                 return 0;
                             case PARAM_LOB:
                                 return 0;
@@ -420,6 +829,7 @@ namespace wpp {
                 case SQLITE_BLOB:
                     return_value.native_type = "blob";
                     return_value.flags.push_back("blob");
+                    break;
                 case SQLITE_TEXT:
                     return_value.native_type = "string";
                     break;
@@ -439,6 +849,12 @@ namespace wpp {
             return 1;
         }
 
+        int sqlite_statement::resetter() {
+            sqlite3_reset(this->_stmt);
+            sqlite3_clear_bindings(this->_stmt);
+            return 1;
+        }
+
         int sqlite_data_object::handle_factory(std::unordered_map<attribute_type, driver_option> driver_options) {
             int i, ret = 0;
             long timeout = 60, flags;
@@ -449,7 +865,19 @@ namespace wpp {
             if (!filename) {
                 std::runtime_error("open_basedir prohibits opening " + this->_data_source);
             } else {
-                flags = SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE;
+                auto option = [&driver_options](long attr) {
+                    auto iter = driver_options.find((wpp::db::attribute_type) attr);
+                    return iter != driver_options.end() ? &iter->second : nullptr;
+                };
+                const driver_option *read_only = option(SQLITE_ATTR_READ_ONLY);
+                const driver_option *threading = option(SQLITE_ATTR_THREADING_MODE);
+                flags = (read_only && read_only->get_bool()) ? SQLITE_OPEN_READONLY
+                                                             : SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE;
+                if (threading && threading->get_int() == SQLITE_THREADING_MULTI_THREAD) {
+                    flags |= SQLITE_OPEN_NOMUTEX;
+                } else if (threading && threading->get_int() == SQLITE_THREADING_SERIALIZED) {
+                    flags |= SQLITE_OPEN_FULLMUTEX;
+                }
                 #if SQLITE_VERSION_NUMBER >= 3005000
                 i = sqlite3_open_v2(filename, &this->_db, flags, NULL);
                 #else
@@ -465,13 +893,343 @@ namespace wpp {
                         }
                     }
                     sqlite3_busy_timeout(this->_db, timeout * 1000);
+                    /* page_size before the journal mode: a WAL database can't change it anymore */
+                    const long pragmas[] = {SQLITE_ATTR_PAGE_SIZE, SQLITE_ATTR_JOURNAL_MODE, SQLITE_ATTR_SYNCHRONOUS,
+                                            SQLITE_ATTR_CACHE_SIZE, SQLITE_ATTR_MMAP_SIZE, SQLITE_ATTR_TEMP_STORE};
+                    ret = 1;
+                    for (long attr : pragmas) {
+                        const driver_option *value = option(attr);
+                        if (value && !this->apply_pragma(attr, *value)) {
+                            ret = 0;
+                            break;
+                        }
+                    }
+                    if (!ret) {
+                        /* all or nothing: a connection without its profile is not handed out */
+                        sqlite3_close(this->_db);
+                        this->_db = nullptr;
+                        return 0;
+                    }
                     this->_alloc_own_columns = 1;
                     this->_max_escaped_char_length = 2;
-                    ret = 1;
                 }
             }
             return ret;
         }
+
+        const char *sqlite_data_object::pragma_name(long attr) {
+            switch (attr) {
+                case SQLITE_ATTR_JOURNAL_MODE:
+                    return "journal_mode";
+                case SQLITE_ATTR_SYNCHRONOUS:
+                    return "synchronous";
+                case SQLITE_ATTR_MMAP_SIZE:
+                    return "mmap_size";
+                case SQLITE_ATTR_CACHE_SIZE:
+                    return "cache_size";
+                case SQLITE_ATTR_TEMP_STORE:
+                    return "temp_store";
+                case SQLITE_ATTR_PAGE_SIZE:
+                    return "page_size";
+                default:
+                    return "";
+            }
+        }
+
+        bool sqlite_data_object::run_pragma(const std::string &pragma, std::string *value) {
+            sqlite3_stmt *stmt = nullptr;
+            if (sqlite3_prepare_v2(this->_db, pragma.c_str(), (int) pragma.size(), &stmt, nullptr) != SQLITE_OK) {
+                sqlite_data_object::sqlite_error(this, nullptr, __FILE__, __LINE__);
+                return false;
+            }
+            const int rc = sqlite3_step(stmt);
+            if (rc != SQLITE_ROW && rc != SQLITE_DONE) {
+                sqlite_data_object::sqlite_error(this, nullptr, __FILE__, __LINE__);
+                sqlite3_finalize(stmt);
+                return false;
+            }
+            if (value) {
+                const char *text = rc == SQLITE_ROW ? (const char *) sqlite3_column_text(stmt, 0) : nullptr;
+                *value = text ? text : "";
+            }
+            sqlite3_finalize(stmt);
+            return true;
+        }
+
+        int sqlite_data_object::apply_pragma(long attr, const driver_option &val) {
+            /* pragmas can't be bound, so only keywords and numbers get into the statement */
+            std::string value = boost::algorithm::to_upper_copy(val.get_string());
+            static const std::regex number("-?[0-9]+");
+            static const std::regex journal_modes("DELETE|TRUNCATE|PERSIST|MEMORY|WAL|OFF");
+            static const std::regex synchronous_levels("OFF|NORMAL|FULL|EXTRA|[0-3]");
+            static const std::regex temp_stores("DEFAULT|FILE|MEMORY|[0-2]");
+            const std::regex &allowed = attr == SQLITE_ATTR_JOURNAL_MODE ? journal_modes :
+                                        attr == SQLITE_ATTR_SYNCHRONOUS ? synchronous_levels :
+                                        attr == SQLITE_ATTR_TEMP_STORE ? temp_stores : number;
+            if (!std::regex_match(value, allowed)) {
+                sqlite_data_object::raise_impl_error(this, nullptr, "HY024", std::string("invalid value '") +
+                                                                            val.get_string() + "' for " +
+                                                                            pragma_name(attr));
+                return 0;
+            }
+            const std::string name = pragma_name(attr);
+            std::string reported;
+            if (!this->run_pragma("PRAGMA " + name + " = " + value, &reported)) {
+                return 0;
+            }
+            if (attr == SQLITE_ATTR_JOURNAL_MODE && boost::algorithm::to_upper_copy(reported) != value) {
+                /* journal_mode answers with the mode in effect, e.g. "memory" for :memory: databases */
+                sqlite_data_object::raise_impl_error(this, nullptr, "HY000", "journal_mode " + value +
+                                                                            " was not applied, the database is in " +
+                                                                            reported + " mode");
+                return 0;
+            }
+            return 1;
+        }
+        sqlite3_blob *sqlite_data_object::open_blob(const std::string &database, const std::string &table,
+                                                    const std::string &column, int64_t rowid, bool writable) {
+            sqlite3_blob *blob = nullptr;
+            if (sqlite3_blob_open(this->_db, database.c_str(), table.c_str(), column.c_str(), rowid, writable ? 1 : 0,
+                                  &blob) != SQLITE_OK) {
+                /* the handle is null on failure, but the error is in the connection */
+                sqlite_data_object::sqlite_error(this, nullptr, __FILE__, __LINE__);
+                data_object::handle_error(*this);
+                return nullptr;
+            }
+            return blob;
+        }
+
+        sqlite_blob_reader sqlite_data_object::blob_reader(const std::string &table, const std::string &column,
+                                                           int64_t rowid, const std::string &database) {
+            sqlite3_blob *blob = this->open_blob(database, table, column, rowid, false);
+            return blob ? sqlite_blob_reader(this, blob) : sqlite_blob_reader();
+        }
+
+        sqlite_blob_writer sqlite_data_object::blob_writer(const std::string &table, const std::string &column,
+                                                           int64_t rowid, const std::string &database) {
+            sqlite3_blob *blob = this->open_blob(database, table, column, rowid, true);
+            return blob ? sqlite_blob_writer(this, blob) : sqlite_blob_writer();
+        }
+
+        bool sqlite_data_object::snapshot(std::string &image, const std::string &database) {
+            sqlite3_int64 size = -1;
+            unsigned char *data = sqlite3_serialize(this->_db, database.c_str(), &size, 0);
+            if (!data && size == 0) {
+                /* a database without pages: its image is empty */
+                image.clear();
+                return true;
+            }
+            if (!data) {
+                /* no such database, or out of memory */
+                sqlite_data_object::raise_impl_error(this, nullptr, "HY000",
+                                                     "could not serialize database " + database);
+                data_object::handle_error(*this);
+                return false;
+            }
+            image.assign((const char *) data, (size_t) size);
+            sqlite3_free(data);
+            return true;
+        }
+
+        bool sqlite_data_object::restore(boost::string_view image, const std::string &database) {
+            /* sqlite owns the copy: it grows it as the database is written and frees it on close */
+            unsigned char *data = (unsigned char *) sqlite3_malloc64(std::max<size_t>(image.size(), 1));
+            if (!data) {
+                sqlite_data_object::raise_impl_error(this, nullptr, "HY001", "out of memory");
+                data_object::handle_error(*this);
+                return false;
+            }
+            std::copy(image.begin(), image.end(), data);
+            int rc = sqlite3_deserialize(this->_db, database.c_str(), data, image.size(), image.size(),
+                                         SQLITE_DESERIALIZE_FREEONCLOSE | SQLITE_DESERIALIZE_RESIZEABLE);
+            if (rc != SQLITE_OK) {
+                /* data was freed already. SQLITE_BUSY: a statement is still reading the database */
+                sqlite_data_object::raise_impl_error(this, nullptr, "HY000", "could not restore database " +
+                                                                            database + ": " + sqlite3_errstr(rc));
+                data_object::handle_error(*this);
+                return false;
+            }
+            return true;
+        }
+
+        sqlite_backup sqlite_data_object::backup_to(const std::string &path, const std::string &database) {
+            sqlite3 *file = this->open_file(path, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE);
+            return file ? this->start_backup(file, "main", this->_db, database, file) : sqlite_backup();
+        }
+
+        sqlite_backup sqlite_data_object::backup_to(sqlite_data_object &destination, const std::string &database,
+                                                    const std::string &destination_database) {
+            return this->start_backup(destination._db, destination_database, this->_db, database, nullptr);
+        }
+
+        sqlite_backup sqlite_data_object::restore_from(const std::string &path, const std::string &database) {
+            sqlite3 *file = this->open_file(path, SQLITE_OPEN_READONLY);
+            return file ? this->start_backup(this->_db, database, file, "main", file) : sqlite_backup();
+        }
+
+        sqlite3 *sqlite_data_object::open_file(const std::string &path, int flags) {
+            sqlite3 *file = nullptr;
+            if (sqlite3_open_v2(path.c_str(), &file, flags, nullptr) != SQLITE_OK) {
+                /* the handle is allocated anyway, with the error in it */
+                std::string message = file ? sqlite3_errmsg(file) : "out of memory";
+                sqlite3_close(file);
+                sqlite_data_object::raise_impl_error(this, nullptr, "HY000", "could not open " + path + ": " + message);
+                data_object::handle_error(*this);
+                return nullptr;
+            }
+            return file;
+        }
+
+        sqlite_backup sqlite_data_object::start_backup(sqlite3 *dest, const std::string &dest_name, sqlite3 *source,
+                                                       const std::string &source_name, sqlite3 *file) {
+            sqlite3_backup *backup = sqlite3_backup_init(dest, dest_name.c_str(), source, source_name.c_str());
+            if (!backup) {
+                /* the error is in the destination connection, e.g. it has a read transaction open */
+                std::string message = sqlite3_errmsg(dest);
+                sqlite3_close(file);
+                sqlite_data_object::raise_impl_error(this, nullptr, "HY000", "could not start the backup: " + message);
+                data_object::handle_error(*this);
+                return sqlite_backup();
+            }
+            return sqlite_backup(this, backup, dest, file);
+        }
+
+        bool sqlite_backup::step(int pages) {
+            if (!this->_backup || this->_done) {
+                return false;
+            }
+            switch (sqlite3_backup_step(this->_backup, pages)) {
+                case SQLITE_OK:
+                    return true;
+                case SQLITE_DONE:
+                    this->_done = true;
+                    return false;
+                case SQLITE_BUSY:
+                case SQLITE_LOCKED:
+                    /* someone else is writing: nothing was copied, try again later */
+                    return true;
+                default:
+                    return this->fail();
+            }
+        }
+
+        bool sqlite_backup::finish() {
+            if (this->_backup) {
+                int rc = sqlite3_backup_finish(this->_backup);
+                this->_backup = nullptr;
+                /* a step that failed already raised its error */
+                if (rc != SQLITE_OK && !this->_failed) {
+                    this->fail();
+                }
+            }
+            this->close();
+            return !this->_failed;
+        }
+
+        void sqlite_backup::close() {
+            if (this->_backup) {
+                sqlite3_backup_finish(this->_backup);
+                this->_backup = nullptr;
+            }
+            if (this->_file) {
+                sqlite3_close(this->_file);
+                this->_file = nullptr;
+            }
+            this->_dest = nullptr;
+        }
+
+        bool sqlite_backup::fail() {
+            this->_failed = true;
+            sqlite_data_object::raise_impl_error(this->_dbh, nullptr, "HY000",
+                                                 std::string("backup failed: ") + sqlite3_errmsg(this->_dest));
+            data_object::handle_error(*this->_dbh);
+            return false;
+        }
+
+        bool sqlite_blob::seek(size_t offset) {
+            if (!this->_blob || offset > this->_size) {
+                return false;
+            }
+            this->_offset = offset;
+            return true;
+        }
+
+        bool sqlite_blob::reopen(int64_t rowid) {
+            if (!this->_blob) {
+                return false;
+            }
+            if (sqlite3_blob_reopen(this->_blob, rowid) != SQLITE_OK) {
+                /* the handle is aborted now: nothing else can be done with it */
+                return this->fail();
+            }
+            this->_size = (size_t) sqlite3_blob_bytes(this->_blob);
+            this->_offset = 0;
+            return true;
+        }
+
+        void sqlite_blob::close() {
+            if (this->_blob) {
+                sqlite3_blob_close(this->_blob);
+                this->_blob = nullptr;
+            }
+            this->_dbh = nullptr;
+            this->_size = 0;
+            this->_offset = 0;
+        }
+
+        bool sqlite_blob::fail() {
+            /* closed before the error is handled: it may throw */
+            sqlite_data_object *dbh = this->_dbh;
+            sqlite_data_object::sqlite_error(dbh, nullptr, __FILE__, __LINE__);
+            this->close();
+            data_object::handle_error(*dbh);
+            return false;
+        }
+
+        long sqlite_blob_reader::read(char *buffer, size_t n) {
+            if (!this->_blob) {
+                return -1;
+            }
+            n = std::min(n, this->_size - this->_offset);
+            if (n == 0) {
+                return 0;
+            }
+            if (sqlite3_blob_read(this->_blob, buffer, (int) n, (int) this->_offset) != SQLITE_OK) {
+                /* SQLITE_ABORT: the row was changed or deleted since the BLOB was opened */
+                this->fail();
+                return -1;
+            }
+            this->_offset += n;
+            return (long) n;
+        }
+
+        bool sqlite_blob_reader::read(std::string &chunk, size_t n) {
+            chunk.resize(std::min(n, this->_size - this->_offset));
+            long got = this->read(&chunk[0], chunk.size());
+            if (got <= 0) {
+                chunk.clear();
+                return false;
+            }
+            return true;
+        }
+
+        bool sqlite_blob_writer::write(const char *data, size_t n) {
+            if (!this->_blob) {
+                return false;
+            }
+            if (n > this->_size - this->_offset) {
+                sqlite_data_object::raise_impl_error(this->_dbh, nullptr, "22001",
+                                              "write past the end of the BLOB; it cannot grow");
+                data_object::handle_error(*this->_dbh);
+                return false;
+            }
+            if (sqlite3_blob_write(this->_blob, data, (int) n, (int) this->_offset) != SQLITE_OK) {
+                return this->fail();
+            }
+            this->_offset += n;
+            return true;
+        }
+
         ///////////////////////////////////////////////////////////////
         //                 TYPE ALIAS WITHOUT TEMPLATE               //
         ///////////////////////////////////////////////////////////////
@@ -0,0 +1,259 @@
+//
+// One writer and many readers on a SQLite database in WAL mode
+//
+#ifndef WPP_SQLITE_CONNECTION_GROUP_H
+#define WPP_SQLITE_CONNECTION_GROUP_H
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include "sqlite.h"
+#include "../connection_pool.h"
+
+namespace wpp {
+    namespace db {
+        ///////////////////////////////////////////////////////////////
+        //                  SQLITE CONNECTION GROUP                  //
+        ///////////////////////////////////////////////////////////////
+        struct sqlite_group_options {
+            // read-only connections, opened as they are needed
+            size_t readers{std::max(2u, std::thread::hardware_concurrency())};
+            // how long a read waits for an idle reader and a write for the writer
+            std::chrono::milliseconds wait_timeout{std::chrono::seconds(30)};
+            // SQL texts whose route is remembered; others are classified again each time
+            size_t remembered_routes{4096};
+        };
+
+        // In WAL mode, readers don't block the writer and the writer doesn't block readers. The group
+        // keeps one connection for writes and a pool of read-only connections to the same file.
+        // Statements are routed with sqlite3_stmt_readonly: reads go to any idle reader, writes wait for
+        // the writer. Transactions span statements, so run them on writer(): prepare() and query() throw
+        // std::invalid_argument for BEGIN, COMMIT, ROLLBACK, SAVEPOINT and RELEASE
+        class sqlite_connection_group {
+            public:
+                using pool_type = connection_pool<sqlite_data_object>;
+                using lease = pool_type::lease;
+
+                // A statement and the connection it runs on, leased until the statement is destroyed
+                class routed_statement {
+                    public:
+                        routed_statement() = default;
+
+                        routed_statement(routed_statement &&other) noexcept = default;
+
+                        routed_statement &operator=(routed_statement &&other) noexcept {
+                            /* the statement goes before its connection is given back */
+                            _stmt.reset();
+                            _conn = std::move(other._conn);
+                            _stmt = std::move(other._stmt);
+                            _is_write = other._is_write;
+                            return *this;
+                        }
+
+                        data_object_statement *operator->() const noexcept { return _stmt.get(); }
+
+                        data_object_statement &operator*() const noexcept { return *_stmt; }
+
+                        const sqlite_data_object::stmt &get() const noexcept { return _stmt; }
+
+                        explicit operator bool() const noexcept { return _stmt != nullptr; }
+
+                        // Where the statement runs, e.g. to read error_info() when prepare failed.
+                        // Null if no connection became available in time
+                        sqlite_data_object *connection() const noexcept { return _conn.get(); }
+
+                        bool is_write() const noexcept { return _is_write; }
+
+                    protected:
+                        friend class sqlite_connection_group;
+
+                        /* declared first, so that it is destroyed last */
+                        lease _conn;
+                        sqlite_data_object::stmt _stmt;
+                        bool _is_write{false};
+                };
+
+                // data_source must be a file: readers of a :memory: database would each have their own
+                sqlite_connection_group(const std::string &data_source,
+                                        sqlite_group_options options = {},
+                                        std::unordered_map<attribute_type, driver_option> driver_options = {})
+                        : _options(checked(data_source, options)),
+                          _writer(factory(data_source, writer_options(driver_options)), single_connection(options)),
+                          _readers(factory(data_source, reader_options(driver_options)), reader_pool(options)),
+                          _classifier_factory(factory(data_source, reader_options(driver_options))) {}
+
+                sqlite_connection_group(const sqlite_connection_group &) = delete;
+
+                sqlite_connection_group &operator=(const sqlite_connection_group &) = delete;
+
+                // An idle read-only connection; empty if none was released in time
+                lease reader() { return _readers.acquire(); }
+
+                // The writer connection, one lease at a time; empty if it was not released in time
+                lease writer() { return _writer.acquire(); }
+
+                // Prepared on a reader, or on the writer if the statement changes the database
+                routed_statement prepare(const std::string &sql,
+                                         std::unordered_map<attribute_type, driver_option> options = {}) {
+                    const route_type route = this->route(sql);
+                    if (route == ROUTE_TRANSACTION) {
+                        /* sqlite3_stmt_readonly is true for these, and the lease would roll them back */
+                        throw std::invalid_argument("sqlite_connection_group: transaction control statements "
+                                                    "must run on writer(): " + sql);
+                    }
+                    routed_statement routed;
+                    routed._is_write = route == ROUTE_WRITE;
+                    routed._conn = routed._is_write ? this->writer() : this->reader();
+                    if (routed._conn) {
+                        routed._stmt = routed._conn->prepare(sql, options);
+                    }
+                    return routed;
+                }
+
+                // prepare() and execute(); empty if either failed
+                routed_statement query(const std::string &sql) {
+                    routed_statement routed = this->prepare(sql);
+                    if (routed && !routed->execute()) {
+                        routed._stmt.reset();
+                    }
+                    return routed;
+                }
+
+                // Runs on the writer, as data_object::exec; -1 if the writer was not released in time
+                long exec(const std::string &sql) {
+                    lease conn = this->writer();
+                    return conn ? conn->exec(sql) : -1;
+                }
+
+                // Open connections: the writer and the readers, leased or idle
+                size_t size() const { return _writer.size() + _readers.size(); }
+
+                const sqlite_group_options &options() const noexcept { return _options; }
+
+            protected:
+                enum route_type {
+                    ROUTE_UNKNOWN,
+                    ROUTE_READ,
+                    ROUTE_WRITE,
+                    ROUTE_TRANSACTION
+                };
+
+                // Whether sql reads or writes, from sqlite3_stmt_readonly on a connection of its own, so
+                // that classifying never waits for the pools. SQL that fails to prepare goes to a reader,
+                // which reports the error
+                route_type route(const std::string &sql) {
+                    std::lock_guard<std::mutex> guard(_routes_mutex);
+                    auto iter = _routes.find(sql);
+                    if (iter != _routes.end()) {
+                        return iter->second;
+                    }
+                    if (!_classifier) {
+                        _classifier = _classifier_factory();
+                    }
+                    sqlite_data_object::stmt stmt = _classifier->prepare(sql);
+                    if (!stmt) {
+                        return ROUTE_UNKNOWN;
+                    }
+                    const route_type result = transaction_control(sql) ? ROUTE_TRANSACTION :
+                                              read_only(stmt) ? ROUTE_READ : ROUTE_WRITE;
+                    if (_routes.size() < _options.remembered_routes) {
+                        _routes.emplace(sql, result);
+                    }
+                    return result;
+                }
+
+                static const sqlite_group_options &checked(const std::string &data_source,
+                                                           const sqlite_group_options &options) {
+                    if (data_source.find(":memory:") != std::string::npos) {
+                        throw std::invalid_argument("sqlite_connection_group: in-memory databases can't be shared");
+                    }
+                    return options;
+                }
+
+                // Whether the first keyword, after spaces and comments, begins or ends a transaction
+                static bool transaction_control(const std::string &sql) {
+                    size_t i = 0;
+                    while (i < sql.size()) {
+                        if (std::isspace((unsigned char) sql[i])) {
+                            ++i;
+                        } else if (sql.compare(i, 2, "--") == 0) {
+                            i = std::min(sql.find('\n', i), sql.size());
+                        } else if (sql.compare(i, 2, "/*") == 0) {
+                            const size_t close = sql.find("*/", i + 2);
+                            i = close == std::string::npos ? sql.size() : close + 2;
+                        } else {
+                            break;
+                        }
+                    }
+                    std::string keyword;
+                    for (; i < sql.size() && std::isalpha((unsigned char) sql[i]); ++i) {
+                        keyword += (char) std::toupper((unsigned char) sql[i]);
+                    }
+                    return keyword == "BEGIN" || keyword == "COMMIT" || keyword == "END" || keyword == "ROLLBACK" ||
+                           keyword == "SAVEPOINT" || keyword == "RELEASE";
+                }
+
+                static bool read_only(const sqlite_data_object::stmt &stmt) {
+                    return static_cast<const sqlite_statement &>(*stmt).read_only();
+                }
+
+                static pool_type::factory_type factory(std::string data_source,
+                                                       std::unordered_map<attribute_type, driver_option> options) {
+                    return [data_source, options]() {
+                        return std::unique_ptr<sqlite_data_object>(new sqlite_data_object(data_source, "", "", options));
+                    };
+                }
+
+                // WAL unless asked otherwise; the connection is only used by one lease at a time
+                static std::unordered_map<attribute_type, driver_option>
+                writer_options(std::unordered_map<attribute_type, driver_option> options) {
+                    options.emplace((attribute_type) SQLITE_ATTR_JOURNAL_MODE, std::string("WAL"));
+                    options.emplace((attribute_type) SQLITE_ATTR_THREADING_MODE, (int) SQLITE_THREADING_MULTI_THREAD);
+                    return options;
+                }
+
+                // Read-only connections can't set the journal mode or the page size: the writer did
+                static std::unordered_map<attribute_type, driver_option>
+                reader_options(std::unordered_map<attribute_type, driver_option> options) {
+                    options.erase((attribute_type) SQLITE_ATTR_JOURNAL_MODE);
+                    options.erase((attribute_type) SQLITE_ATTR_PAGE_SIZE);
+                    options[(attribute_type) SQLITE_ATTR_READ_ONLY] = true;
+                    options.emplace((attribute_type) SQLITE_ATTR_THREADING_MODE, (int) SQLITE_THREADING_MULTI_THREAD);
+                    return options;
+                }
+
+                // The writer is opened first, so that the file exists and is in WAL mode for the readers
+                static pool_options single_connection(const sqlite_group_options &options) {
+                    pool_options single;
+                    single.min_size = 1;
+                    single.max_size = 1;
+                    single.idle_timeout = std::chrono::milliseconds(0);
+                    single.wait_timeout = options.wait_timeout;
+                    return single;
+                }
+
+                static pool_options reader_pool(const sqlite_group_options &options) {
+                    pool_options readers;
+                    readers.max_size = std::max<size_t>(1, options.readers);
+                    readers.wait_timeout = options.wait_timeout;
+                    return readers;
+                }
+
+                sqlite_group_options _options;
+                pool_type _writer;
+                pool_type _readers;
+                /* whether each SQL text reads or writes, so that it is classified once */
+                pool_type::factory_type _classifier_factory;
+                std::mutex _routes_mutex;
+                std::unique_ptr<sqlite_data_object> _classifier;
+                std::unordered_map<std::string, route_type> _routes;
+        };
+    }
+}
+
+#endif //WPP_SQLITE_CONNECTION_GROUP_H
@@ -5,20 +5,209 @@
 #define WPP_RESULT_CONTAINER_H
 
 #include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
 #include <cstring>
 #include <utility>
+#include <type_traits>
 #include <iterator>
+#include <ostream>
 #include <stdexcept>
 #include <algorithm>
 #include <vector>
 #include <string>
+#include <memory>
 #include <initializer_list>
 #include <boost/algorithm/string/case_conv.hpp>
+#include <boost/utility/string_view.hpp>
 
 namespace wpp {
     namespace db {
         enum data_type { STRING, INTEGER, REAL, BOOLEAN, NULL_DATA };
 
+        // A typed field that points into the driver buffers; valid until the next fetch
+        class field_view {
+            public:
+                field_view() : _data(nullptr), _size(0), _data_type(NULL_DATA), _int(0) {}
+
+                field_view(const char *data, size_t size, data_type type = STRING) :
+                        _data(data), _size(size), _data_type(type), _int(0) {}
+
+                // Native values, optionally with the text the driver already has for them
+                explicit field_view(int64_t n, const char *text = nullptr, size_t size = 0) :
+                        _data(text), _size(size), _data_type(INTEGER), _int(n) {}
+
+                explicit field_view(double n, const char *text = nullptr, size_t size = 0) :
+                        _data(text), _size(size), _data_type(REAL), _real(n) {}
+
+                explicit field_view(bool b, const char *text = nullptr, size_t size = 0) :
+                        _data(text), _size(size), _data_type(BOOLEAN), _int(b) {}
+
+                data_type type() const noexcept { return _data_type; }
+
+                bool is_null() const noexcept { return _data_type == NULL_DATA; }
+
+                // Text the driver holds for this value. Natively fetched numbers and booleans have none:
+                // data() is null and str() empty, use to_string() or compare with == to see them as text
+                const char *data() const noexcept { return _data; }
+
+                size_t size() const noexcept { return _size; }
+
+                bool empty() const noexcept { return _size == 0; }
+
+                boost::string_view str() const noexcept { return boost::string_view(_data, _size); }
+
+                operator boost::string_view() const noexcept { return this->str(); }
+
+                // Typed access: converts only when the stored type is different
+                int64_t get_int() const {
+                    switch (_data_type) {
+                        case INTEGER:
+                        case BOOLEAN:
+                            return _int;
+                        case REAL:
+                            return int64_t(_real);
+                        case STRING:
+                            return parse<int64_t>(_data, _size);
+                        default:
+                            return 0;
+                    }
+                }
+
+                // Same as get_int, but text above INT64_MAX is parsed instead of clamped
+                uint64_t get_uint() const {
+                    if (_data_type == STRING) {
+                        return parse<uint64_t>(_data, _size);
+                    }
+                    return uint64_t(this->get_int());
+                }
+
+                double get_real() const {
+                    switch (_data_type) {
+                        case REAL:
+                            return _real;
+                        case INTEGER:
+                        case BOOLEAN:
+                            return double(_int);
+                        case STRING:
+                            return parse<double>(_data, _size);
+                        default:
+                            return 0.0;
+                    }
+                }
+
+                bool get_bool() const {
+                    switch (_data_type) {
+                        case INTEGER:
+                        case BOOLEAN:
+                            return _int != 0;
+                        case REAL:
+                            return _real != 0.0;
+                        case STRING:
+                            return _size && (_data[0] == '1' || _data[0] == 't' || _data[0] == 'T');
+                        default:
+                            return false;
+                    }
+                }
+
+                std::string to_string() const {
+                    if (_data || _data_type == STRING) {
+                        return std::string(_data, _size);
+                    }
+                    switch (_data_type) {
+                        case INTEGER:
+                            return std::to_string(_int);
+                        case REAL:
+                            return format_real(_real);
+                        case BOOLEAN:
+                            return _int ? "true" : "false";
+                        default:
+                            return "";
+                    }
+                }
+
+                template<typename T>
+                T as(typename std::enable_if<std::is_same<T, bool>::value, int>::type = 0) const {
+                    return this->get_bool();
+                }
+
+                template<typename T>
+                T as(typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value,
+                        int>::type = 0) const {
+                    return std::is_unsigned<T>::value ? T(this->get_uint()) : T(this->get_int());
+                }
+
+                template<typename T>
+                T as(typename std::enable_if<std::is_floating_point<T>::value, int>::type = 0) const {
+                    return T(this->get_real());
+                }
+
+                template<typename T>
+                T as(typename std::enable_if<std::is_same<T, std::string>::value, int>::type = 0) const {
+                    return this->to_string();
+                }
+
+                // Native values without driver text are compared through to_string()
+                bool operator==(boost::string_view rhs) const {
+                    if (_data || _data_type == STRING) {
+                        return this->str() == rhs;
+                    }
+                    return this->to_string() == rhs;
+                }
+
+                bool operator!=(boost::string_view rhs) const { return !(*this == rhs); }
+
+                friend std::ostream &operator<<(std::ostream &os, const field_view &f) {
+                    if (f._data) {
+                        return os.write(f._data, f._size);
+                    }
+                    return os << f.to_string();
+                }
+
+                // sqlite's "%!.15g": 15 significant digits and always a decimal point
+                static std::string format_real(double n) {
+                    char buf[32];
+                    int len = std::snprintf(buf, sizeof(buf), "%.15g", n);
+                    if (len > 0 && std::strpbrk(buf, ".eEnN") == nullptr) {
+                        std::strcat(buf, ".0");
+                    }
+                    return buf;
+                }
+
+            protected:
+                template<typename T>
+                static T parse(const char *data, size_t size) {
+                    if (!size) {
+                        return T(0);
+                    }
+                    /* driver text is not always null terminated: short text is copied to the stack, longer
+                     * text (e.g. a NUMERIC with many digits) to the heap, never cut */
+                    char buf[64];
+                    std::string long_text;
+                    const char *text = buf;
+                    if (size < sizeof(buf)) {
+                        std::memcpy(buf, data, size);
+                        buf[size] = '\0';
+                    } else {
+                        long_text.assign(data, size);
+                        text = long_text.c_str();
+                    }
+                    if (std::is_floating_point<T>::value) {
+                        return T(std::strtod(text, nullptr));
+                    }
+                    return std::is_unsigned<T>::value ? T(std::strtoull(text, nullptr, 10)) : T(std::strtoll(text, nullptr, 10));
+                }
+
+                const char *_data;
+                size_t _size;
+                data_type _data_type;
+                union {
+                    int64_t _int;
+                    double _real;
+                };
+        };
+
         class field
                 : public std::string {
             public:
@@ -27,24 +216,49 @@ namespace wpp {
 
                 field(std::string &s) : std::string(s), _data_type(STRING) {}
 
-                field(bool c) : std::string(c ? "TRUE" : "FALSE"), _data_type(BOOLEAN) {}
-
-                field(int n) : std::string(std::to_string(n)), _data_type(INTEGER) {}
-
-                field(double n) : std::string(std::to_string(n)), _data_type(REAL) {}
-
-                field(float n) : std::string(std::to_string(n)), _data_type(REAL) {}
+                field(bool c) : std::string(c ? "true" : "false"), _data_type(BOOLEAN), _int_value(c) {}
+
+                field(int n) : std::string(std::to_string(n)), _data_type(INTEGER), _int_value(n) {}
+
+                field(long long n) : std::string(std::to_string(n)), _data_type(INTEGER), _int_value(n) {}
+
+                field(double n) : std::string(std::to_string(n)), _data_type(REAL), _real_value(n) {}
+
+                field(float n) : std::string(std::to_string(n)), _data_type(REAL), _real_value(n) {}
+
+                // Keep the native value next to its text, so conversions back don't parse. The text can't be
+                // made lazy: a field is a std::string, and callers read it through std::string members that
+                // can't be intercepted. fetch_view, fetch_into and columnar results skip the formatting
+                field(const field_view &v) : _data_type(v.type()) {
+                    switch (v.type()) {
+                        case INTEGER:
+                            _int_value = v.get_int();
+                            std::string::operator=(v.to_string());
+                            break;
+                        case REAL:
+                            _real_value = v.get_real();
+                            std::string::operator=(v.to_string());
+                            break;
+                        case BOOLEAN:
+                            _int_value = v.get_bool();
+                            std::string::operator=(_int_value ? "true" : "false");
+                            break;
+                        case STRING:
+                            this->assign(v.data(), v.size());
+                            break;
+                        default:
+                            break;
+                    }
+                }
 
                 // Convert to...
                 operator bool() const {
                     if (_data_type == BOOLEAN) {
-                        if (*this == "1" || *this == "True" || *this == "TRUE" || *this == "true") {
-                            return true;
-                        };
+                        return _int_value != 0;
                     } else if (_data_type == INTEGER) {
-                        return !this->empty() && *this != "0";
+                        return _int_value != 0;
                     } else if (_data_type == REAL) {
-                        return !this->empty();
+                        return _real_value != 0.0;
                     } else if (_data_type == STRING) {
                         return !this->empty();
                     } else if (_data_type == NULL_DATA) {
@@ -53,36 +267,52 @@ namespace wpp {
                     return false;
                 }
 
-                operator int() const { return this->empty() ? 0 : std::stoi(*this); }
+                operator int() const { return this->is_native() ? (int) native_int() : this->empty() ? 0 : std::stoi(*this); }
 
-                operator long() const { return this->empty() ? 0 : std::stol(*this); }
+                operator long() const { return this->is_native() ? (long) native_int() : this->empty() ? 0 : std::stol(*this); }
 
-                operator unsigned int() const { return this->empty() ? 0 : std::stoul(*this); }
+                operator unsigned int() const {
+                    return this->is_native() ? (unsigned int) native_int() : this->empty() ? 0 : std::stoul(*this);
+                }
 
-                operator long long() const { return this->empty() ? 0 : std::stoll(*this); }
+                operator long long() const {
+                    return this->is_native() ? native_int() : this->empty() ? 0 : std::stoll(*this);
+                }
 
-                operator unsigned long long() const { return this->empty() ? 0 : std::stoull(*this); }
+                operator unsigned long long() const {
+                    return this->is_native() ? (unsigned long long) native_int() : this->empty() ? 0 : std::stoull(*this);
+                }
 
-                operator float() const { return this->empty() ? 0.0 : std::stof(*this); }
+                operator float() const {
+                    return this->is_native() ? (float) native_real() : this->empty() ? 0.0 : std::stof(*this);
+                }
 
-                operator double() const { return this->empty() ? 0.0 : std::stod(*this); }
+                operator double() const {
+                    return this->is_native() ? native_real() : this->empty() ? 0.0 : std::stod(*this);
+                }
 
-                operator long double() const { return this->empty() ? 0.0 : std::stold(*this); }
+                operator long double() const {
+                    return this->is_native() ? native_real() : this->empty() ? 0.0 : std::stold(*this);
+                }
 
                 template<typename T>
                 bool operator>>(T &obj) const { return to(obj); }
 
                 field &operator=(const field &rhs) {
                     std::string::operator=(rhs);
+                    _data_type = rhs._data_type;
+                    _int_value = rhs._int_value;
+                    _real_value = rhs._real_value;
                     return *this;
                 };
 
                 field &operator=(const std::string &rhs) {
                     std::string::operator=(rhs);
+                    _data_type = STRING;
                     return *this;
                 };
 
-                field &operator=(const int &a) { return *this = std::to_string(a); };
+                field &operator=(const int &a) { return *this = field(a); };
 
                 /// Column name
                 std::string name() const { return this->_table_column; }
@@ -111,6 +341,18 @@ namespace wpp {
                 size_t col() const noexcept { return size_t(m_col); }
 
             protected:
+                bool is_native() const noexcept {
+                    return _data_type == INTEGER || _data_type == REAL || _data_type == BOOLEAN;
+                }
+
+                long long native_int() const noexcept {
+                    return _data_type == REAL ? (long long) _real_value : _int_value;
+                }
+
+                double native_real() const noexcept {
+                    return _data_type == REAL ? _real_value : (double) _int_value;
+                }
+
                 size_t m_row;
                 size_t m_col;
                 std::string _table;
@@ -118,6 +360,153 @@ namespace wpp {
                 std::string _value;
                 std::string _error;
                 data_type _data_type;
+                long long _int_value{0};
+                double _real_value{0.0};
+        };
+
+        // Column header shared by every row of a statement
+        class row_schema {
+            public:
+                row_schema() {}
+
+                row_schema(std::vector<std::string> names, std::vector<data_type> types) {
+                    for (size_t i = 0; i < names.size(); ++i) {
+                        this->push_back(names[i], i < types.size() ? types[i] : STRING);
+                    }
+                }
+
+                size_t size() const noexcept { return _names.size(); }
+
+                const std::string &name(size_t n) const { return _names[n]; }
+
+                data_type type(size_t n) const { return _types[n]; }
+
+                const std::vector<std::string> &names() const noexcept { return _names; }
+
+                // Column number from name (size() if there is no such column)
+                size_t column_number(const char *column_name, size_t len) const {
+                    if (_slots.empty()) {
+                        return this->size();
+                    }
+                    const uint32_t h = hash(column_name, len);
+                    const size_t mask = _slots.size() - 1;
+                    for (size_t i = h & mask; _slots[i] != 0; i = (i + 1) & mask) {
+                        const size_t n = _slots[i] - 1;
+                        if (_hashes[n] == h && _names[n].size() == len &&
+                            std::memcmp(_names[n].data(), column_name, len) == 0) {
+                            return n;
+                        }
+                    }
+                    return this->size();
+                }
+
+                size_t column_number(const char column_name[]) const {
+                    return column_number(column_name, std::strlen(column_name));
+                }
+
+                size_t column_number(const std::string &column_name) const {
+                    return column_number(column_name.data(), column_name.size());
+                }
+
+                void push_back(std::string column_name, data_type type = STRING) {
+                    _hashes.push_back(hash(column_name.data(), column_name.size()));
+                    _names.push_back(std::move(column_name));
+                    _types.push_back(type);
+                    if (_slots.size() < 2 * _names.size()) {
+                        this->rehash();
+                    } else {
+                        this->insert_slot(_names.size() - 1);
+                    }
+                }
+
+                // Set the name of column n in a schema that might be shared (copy on write)
+                static void set_column(std::shared_ptr<const row_schema> &schema,
+                                       size_t n,
+                                       std::string column_name,
+                                       data_type type = STRING) {
+                    std::shared_ptr<row_schema> s = (schema && schema.use_count() == 1) ?
+                                                    std::const_pointer_cast<row_schema>(schema) :
+                                                    std::make_shared<row_schema>(schema ? *schema : row_schema());
+                    while (s->size() < n) {
+                        s->push_back("");
+                    }
+                    if (n < s->size()) {
+                        std::vector<std::string> names = s->_names;
+                        std::vector<data_type> types = s->_types;
+                        names[n] = column_name;
+                        types[n] = type;
+                        *s = row_schema(names, types);
+                    } else {
+                        s->push_back(column_name, type);
+                    }
+                    schema = s;
+                }
+
+            protected:
+                // FNV-1a
+                static uint32_t hash(const char *data, size_t len) {
+                    uint32_t h = 2166136261u;
+                    for (size_t i = 0; i < len; ++i) {
+                        h = (h ^ (unsigned char) data[i]) * 16777619u;
+                    }
+                    return h;
+                }
+
+                // Open addressing table with at most 50% load, built once per statement
+                void rehash() {
+                    size_t n = 8;
+                    while (n < 2 * _names.size()) {
+                        n *= 2;
+                    }
+                    _slots.assign(n, 0);
+                    for (size_t i = 0; i < _names.size(); ++i) {
+                        this->insert_slot(i);
+                    }
+                }
+
+                void insert_slot(size_t n) {
+                    /* the first column with a given name wins */
+                    if (this->column_number(_names[n]) < n) {
+                        return;
+                    }
+                    const size_t mask = _slots.size() - 1;
+                    size_t i = _hashes[n] & mask;
+                    while (_slots[i] != 0) {
+                        i = (i + 1) & mask;
+                    }
+                    _slots[i] = uint32_t(n + 1);
+                }
+
+                std::vector<std::string> _names;
+                std::vector<data_type> _types;
+                std::vector<uint32_t> _hashes;
+                std::vector<uint32_t> _slots;
+        };
+
+        // A column name resolved once against a schema and then used positionally. Lookups update the
+        // cached position, so a handle belongs to one thread; give each thread its own
+        class column_handle {
+            public:
+                explicit column_handle(std::string column_name) : _name(std::move(column_name)) {}
+
+                explicit column_handle(const char column_name[]) : _name(column_name) {}
+
+                const std::string &name() const noexcept { return _name; }
+
+                size_t column_number(const std::shared_ptr<const row_schema> &schema) {
+                    /* compared by owner, so an expired schema can't be mistaken for a new one at its address */
+                    if (_schema.owner_before(schema) || schema.owner_before(_schema)) {
+                        _schema = schema;
+                        _index = schema ? schema->column_number(_name) : 0;
+                    }
+                    return _index;
+                }
+
+            protected:
+                std::string _name;
+                /* weak, so that the handle doesn't keep an old schema alive */
+                std::weak_ptr<const row_schema> _schema;
+                size_t _index{0};
         };
 
         class row
@@ -135,19 +524,29 @@ namespace wpp {
                 const_reference operator[](size_t n) const { return vector<field>::operator[](n); };
 
                 reference operator[](const std::string &s) {
-                    return vector<field>::operator[](this->column_number(s.c_str()));
+                    return vector<field>::operator[](this->column_number(s));
                 }
 
                 const_reference operator[](const std::string &s) const {
-                    return vector<field>::operator[](this->column_number(s.c_str()));
+                    return vector<field>::operator[](this->column_number(s));
                 }
 
                 template<int N>
-                reference operator[](const char (&f)[N]) { return vector<field>::operator[](this->column_number(f)); }
+                reference operator[](const char (&f)[N]) {
+                    return vector<field>::operator[](this->column_number(f, std::strlen(f)));
+                }
 
                 template<int N>
                 const_reference operator[](const char (&f)[N]) const {
-                    return vector<field>::operator[](this->column_number(f));
+                    return vector<field>::operator[](this->column_number(f, std::strlen(f)));
+                }
+
+                reference operator[](column_handle &h) {
+                    return vector<field>::operator[](h.column_number(this->_schema));
+                }
+
+                const_reference operator[](column_handle &h) const {
+                    return vector<field>::operator[](h.column_number(this->_schema));
                 }
 
                 // at operator
@@ -155,10 +554,16 @@ namespace wpp {
 
                 const_reference at(const char f[]) const { return vector<field>::at(this->column_number(f)); }
 
-                reference at(const std::string &s) { return vector<field>::at(this->column_number(s.c_str())); }
+                reference at(const std::string &s) { return vector<field>::at(this->column_number(s)); }
 
                 const_reference at(const std::string &s) const {
-                    return vector<field>::at(this->column_number(s.c_str()));
+                    return vector<field>::at(this->column_number(s));
+                }
+
+                reference at(column_handle &h) { return vector<field>::at(h.column_number(this->_schema)); }
+
+                const_reference at(column_handle &h) const {
+                    return vector<field>::at(h.column_number(this->_schema));
                 }
 
                 // Implicit conversion operator
@@ -175,25 +580,35 @@ namespace wpp {
                 size_t num_of_fields() { return this->size(); }
 
                 /// Column number from name
+                size_t column_number(const char *column_name, size_t len) const {
+                    return this->_schema ? this->_schema->column_number(column_name, len) : this->size();
+                }
+
                 size_t column_number(const char column_name[]) const {
-                    return std::find_if(this->_columns.begin(), this->_columns.end(),
-                                        [column_name](std::shared_ptr<std::string> const &x) {
-                                            return (x) ? *x == column_name : false;
-                                        }) - this->_columns.begin();
+                    return column_number(column_name, std::strlen(column_name));
                 }
 
                 size_t column_number(const std::string &column_name) const {
-                    return column_number(column_name.c_str());
+                    return column_number(column_name.data(), column_name.size());
+                }
+
+                size_t column_number(column_handle &h) const {
+                    return h.column_number(this->_schema);
                 }
 
                 // Column name from number
-                std::string column_name(size_t n) const { return (this->_columns[n]) ? *this->_columns[n] : ""; }
+                std::string column_name(size_t n) const {
+                    return (this->_schema && n < this->_schema->size()) ? this->_schema->name(n) : "";
+                }
 
                 // Column type
                 data_type column_type(size_t n) const {
-                    return this->_data_types[n];
+                    return (this->_schema && n < this->_schema->size()) ? this->_schema->type(n) : STRING;
                 }
 
+                /// Column header shared with the statement
+                const std::shared_ptr<const row_schema> &schema() const noexcept { return this->_schema; }
+
                 unsigned int column_type(const std::string &column_name) const {
                     return column_type(column_number(column_name));
                 }
@@ -226,23 +641,25 @@ namespace wpp {
                 ///////////////////////////////////////////////////////////////
                 //                           SETTERS                         //
                 ///////////////////////////////////////////////////////////////
+                void set_schema(std::shared_ptr<const row_schema> schema) {
+                    this->_schema = std::move(schema);
+                }
+
                 // push_back with column name
                 void push_back(field data) {
                     vector<field>::push_back(data);
-                    _columns.emplace_back(nullptr);
-                    _data_types.emplace_back(STRING);
                 }
 
                 void push_back(std::string column_name, field data) {
+                    row_schema::set_column(this->_schema, this->size(), column_name);
                     vector<field>::push_back(data);
-                    _columns.emplace_back(new std::string(column_name));
-                    _data_types.emplace_back(STRING);
                 }
 
                 void push_back(std::shared_ptr<std::string> column_name, field data) {
+                    if (column_name) {
+                        row_schema::set_column(this->_schema, this->size(), *column_name);
+                    }
                     vector<field>::push_back(data);
-                    _columns.emplace_back(column_name);
-                    _data_types.emplace_back(STRING);
                 }
 
                 ///////////////////////////////////////////////////////////////
@@ -261,11 +678,90 @@ namespace wpp {
                 //    return *this;
                 //}
             protected:
-                std::vector<std::shared_ptr<std::string>> _columns;
-                std::vector<data_type> _data_types;
+                std::shared_ptr<const row_schema> _schema;
                 unsigned int m_index;
         };
 
+        // A row of field views owned by the statement; valid until the next fetch
+        class row_view {
+            public:
+                using const_iterator = const field_view *;
+
+                row_view() : _fields(nullptr), _size(0), _schema(nullptr) {}
+
+                row_view(const field_view *fields, size_t size, const std::shared_ptr<const row_schema> *schema) :
+                        _fields(fields), _size(size), _schema(schema) {}
+
+                const field_view &operator[](size_t n) const { return _fields[n]; }
+
+                // By name: std::out_of_range if there is no such column or no schema at all (e.g. rows of COPY)
+                const field_view &operator[](const std::string &s) const {
+                    return this->named_field(this->column_number(s), s.data(), s.size());
+                }
+
+                template<int N>
+                const field_view &operator[](const char (&f)[N]) const {
+                    const size_t len = std::strlen(f);
+                    const size_t n = (_schema && *_schema) ? (*_schema)->column_number(f, len) : _size;
+                    return this->named_field(n, f, len);
+                }
+
+                const field_view &operator[](column_handle &h) const {
+                    const size_t n = (_schema && *_schema) ? h.column_number(*_schema) : _size;
+                    return this->named_field(n, h.name().data(), h.name().size());
+                }
+
+                const field_view &at(size_t n) const {
+                    if (n >= _size) {
+                        throw std::out_of_range("row_view::at");
+                    }
+                    return _fields[n];
+                }
+
+                size_t column_number(const std::string &column_name) const {
+                    return (_schema && *_schema) ? (*_schema)->column_number(column_name) : _size;
+                }
+
+                std::string column_name(size_t n) const {
+                    return (_schema && *_schema && n < (*_schema)->size()) ? (*_schema)->name(n) : "";
+                }
+
+                size_t size() const noexcept { return _size; }
+
+                bool empty() const noexcept { return _size == 0; }
+
+                operator bool() const noexcept { return _size != 0; }
+
+                const_iterator begin() const noexcept { return _fields; }
+
+                const_iterator end() const noexcept { return _fields + _size; }
+
+                // Copy the viewed values into a regular row
+                row to_row() const {
+                    row r;
+                    r.reserve(_size);
+                    if (_schema) {
+                        r.set_schema(*_schema);
+                    }
+                    for (size_t i = 0; i < _size; ++i) {
+                        r.push_back(field(_fields[i]));
+                    }
+                    return r;
+                }
+
+            protected:
+                const field_view &named_field(size_t n, const char *name, size_t len) const {
+                    if (n >= _size) {
+                        throw std::out_of_range("row_view: no column " + std::string(name, len));
+                    }
+                    return _fields[n];
+                }
+
+                const field_view *_fields;
+                size_t _size;
+                const std::shared_ptr<const row_schema> *_schema;
+        };
+
         class result
                 : public std::vector<row> {
             public:
@@ -276,12 +772,16 @@ namespace wpp {
 
                 result(size_t n, std::initializer_list<std::string> column_names) :
                         std::vector<row>(n, wpp::db::row(column_names.size())),
-                        _columns(column_names.begin(), column_names.end()),
-                        _data_types(_columns.size(), data_type::STRING) {};
+                        _schema(std::make_shared<row_schema>(std::vector<std::string>(column_names),
+                                                             std::vector<data_type>())) {
+                    for (row &r : *this) {
+                        r.set_schema(this->_schema);
+                    }
+                };
 
                 // Number of columns
                 size_t columns() const noexcept {
-                    return this->_columns.size();
+                    return this->_schema ? this->_schema->size() : 0;
                 }
 
                 size_t size_rows() const noexcept {
@@ -289,25 +789,35 @@ namespace wpp {
                 }
 
                 size_t size_columns() const noexcept {
-                    return this->_columns.size();
+                    return this->columns();
                 }
 
                 // Column number
                 size_t column_number(const char column_name[]) const {
-                    return std::find(this->_columns.begin(), this->_columns.end(), column_name) -
-                           this->_columns.begin();
+                    return this->_schema ? this->_schema->column_number(column_name) : 0;
                 }
 
                 size_t column_number(const std::string &column_name) const {
-                    return column_number(column_name.c_str());
+                    return this->_schema ? this->_schema->column_number(column_name) : 0;
+                }
+
+                size_t column_number(column_handle &h) const {
+                    return h.column_number(this->_schema);
                 }
 
                 // Column name
-                std::string column_name(size_t n) const { return this->_columns[n]; }
+                std::string column_name(size_t n) const { return this->_schema->name(n); }
 
                 // Column type
                 data_type column_type(size_t n) const {
-                    return this->_data_types[n];
+                    return this->_schema->type(n);
+                }
+
+                /// Column header shared by the rows
+                const std::shared_ptr<const row_schema> &schema() const noexcept { return this->_schema; }
+
+                void set_schema(std::shared_ptr<const row_schema> schema) {
+                    this->_schema = std::move(schema);
                 }
 
                 data_type column_type(int n) const { return column_type(size_t(n)); }
@@ -354,6 +864,10 @@ namespace wpp {
                     return this->pluck(this->column_number(value), this->column_number(key));
                 }
 
+                vector <field> pluck(column_handle &h) {
+                    return this->pluck(this->column_number(h));
+                }
+
                 vector <field> pluck(size_t pos) {
                     vector <field> r;
                     r.reserve(this->size());
@@ -373,8 +887,323 @@ namespace wpp {
                 }
 
             protected:
-                std::vector<std::string> _columns;
-                std::vector<data_type> _data_types;
+                std::shared_ptr<const row_schema> _schema;
+        };
+
+        class columnar_result {
+            public:
+                // One contiguous buffer per column
+                class column {
+                    public:
+                        column(std::string name = "", data_type type = STRING) : _name(name), _type(type) {
+                            if (_type == STRING) {
+                                _offsets.push_back(0);
+                            }
+                        }
+
+                        const std::string &name() const noexcept { return _name; }
+
+                        data_type type() const noexcept { return _type; }
+
+                        size_t size() const noexcept { return _size; }
+
+                        bool is_null(size_t n) const {
+                            return (_nulls[n / 64] >> (n % 64)) & 1;
+                        }
+
+                        int64_t get_int(size_t n) const { return _ints[n]; }
+
+                        double get_real(size_t n) const { return _reals[n]; }
+
+                        bool get_bool(size_t n) const { return _bools[n] != 0; }
+
+                        boost::string_view get_text(size_t n) const {
+                            return boost::string_view(_bytes.data() + _offsets[n], _offsets[n + 1] - _offsets[n]);
+                        }
+
+                        // Raw buffers
+                        const std::vector<int64_t> &ints() const noexcept { return _ints; }
+
+                        const std::vector<double> &reals() const noexcept { return _reals; }
+
+                        const std::vector<uint8_t> &bools() const noexcept { return _bools; }
+
+                        const std::vector<size_t> &offsets() const noexcept { return _offsets; }
+
+                        const std::string &bytes() const noexcept { return _bytes; }
+
+                        const std::vector<uint64_t> &null_bitmap() const noexcept { return _nulls; }
+
+                        // A field copy of the cell, for code written against row
+                        field get_field(size_t n) const {
+                            if (this->is_null(n)) {
+                                return field();
+                            }
+                            switch (_type) {
+                                case INTEGER:
+                                    return field((long long) _ints[n]);
+                                case REAL:
+                                    /* same text as a fetched row, not std::to_string's six decimals */
+                                    return field(field_view(_reals[n]));
+                                case BOOLEAN:
+                                    return field(_bools[n] != 0);
+                                default: {
+                                    std::string s = this->get_text(n).to_string();
+                                    return field(s);
+                                }
+                            }
+                        }
+
+                        void reserve(size_t n) {
+                            _nulls.reserve(n / 64 + 1);
+                            switch (_type) {
+                                case INTEGER:
+                                    _ints.reserve(n);
+                                    break;
+                                case REAL:
+                                    _reals.reserve(n);
+                                    break;
+                                case BOOLEAN:
+                                    _bools.reserve(n);
+                                    break;
+                                default:
+                                    _offsets.reserve(n + 1);
+                            }
+                        }
+
+                        // Append a cell from a typed view
+                        void push_back(const field_view &v) {
+                            if (v.is_null()) {
+                                this->push_back(nullptr, 0, true);
+                                return;
+                            }
+                            switch (_type) {
+                                case INTEGER:
+                                    _ints.push_back(v.get_int());
+                                    break;
+                                case REAL:
+                                    _reals.push_back(v.get_real());
+                                    break;
+                                case BOOLEAN:
+                                    _bools.push_back(v.get_bool());
+                                    break;
+                                default:
+                                    if (v.data() || v.type() == STRING) {
+                                        _bytes.append(v.data(), v.size());
+                                    } else {
+                                        _bytes += v.to_string();
+                                    }
+                                    _offsets.push_back(_bytes.size());
+                            }
+                            if (_size % 64 == 0) {
+                                _nulls.push_back(0);
+                            }
+                            ++_size;
+                        }
+
+                        // Append a cell from its text representation
+                        void push_back(const char *data, size_t len, bool null) {
+                            if (_size % 64 == 0) {
+                                _nulls.push_back(0);
+                            }
+                            if (null) {
+                                _nulls.back() |= uint64_t(1) << (_size % 64);
+                            }
+                            switch (_type) {
+                                case INTEGER:
+                                    _ints.push_back(null || !len ? 0 : std::strtoll(data, nullptr, 10));
+                                    break;
+                                case REAL:
+                                    _reals.push_back(null || !len ? 0.0 : std::strtod(data, nullptr));
+                                    break;
+                                case BOOLEAN:
+                                    _bools.push_back(!null && len && (data[0] == '1' || data[0] == 't' || data[0] == 'T'));
+                                    break;
+                                default:
+                                    if (!null) {
+                                        _bytes.append(data, len);
+                                    }
+                                    _offsets.push_back(_bytes.size());
+                            }
+                            ++_size;
+                        }
+
+                    protected:
+                        std::string _name;
+                        data_type _type;
+                        size_t _size{0};
+                        std::vector<int64_t> _ints;
+                        std::vector<double> _reals;
+                        std::vector<uint8_t> _bools;
+                        std::vector<size_t> _offsets;
+                        std::string _bytes;
+                        std::vector<uint64_t> _nulls;
+                };
+
+                // Cheap row adapter over the columns, so r["name"] code keeps working
+                class row_reference {
+                    public:
+                        row_reference(const columnar_result *res, size_t n) : _res(res), _n(n) {}
+
+                        field operator[](size_t col) const { return _res->_columns[col].get_field(_n); }
+
+                        field operator[](const std::string &s) const {
+                            return this->operator[](_res->column_number(s));
+                        }
+
+                        template<int N>
+                        field operator[](const char (&f)[N]) const { return this->operator[](_res->column_number(f)); }
+
+                        field operator[](column_handle &h) const {
+                            return this->operator[](_res->column_number(h));
+                        }
+
+                        bool is_null(size_t col) const { return _res->_columns[col].is_null(_n); }
+
+                        size_t size() const noexcept { return _res->_columns.size(); }
+
+                        size_t row_number() const noexcept { return _n; }
+
+                        // Materialize as a regular row
+                        row to_row() const {
+                            row r;
+                            r.reserve(this->size());
+                            r.set_schema(_res->_schema);
+                            for (size_t i = 0; i < this->size(); ++i) {
+                                r.push_back(this->operator[](i));
+                            }
+                            return r;
+                        }
+
+                    protected:
+                        const columnar_result *_res;
+                        size_t _n;
+                };
+
+                class const_iterator {
+                    public:
+                        using iterator_category = std::forward_iterator_tag;
+                        using value_type = row_reference;
+                        using difference_type = std::ptrdiff_t;
+                        using pointer = void;
+                        using reference = row_reference;
+
+                        const_iterator(const columnar_result *res, size_t n) : _res(res), _n(n) {}
+
+                        row_reference operator*() const { return row_reference(_res, _n); }
+
+                        const_iterator &operator++() {
+                            ++_n;
+                            return *this;
+                        }
+
+                        const_iterator operator++(int) {
+                            const_iterator tmp = *this;
+                            ++_n;
+                            return tmp;
+                        }
+
+                        bool operator==(const const_iterator &rhs) const { return _n == rhs._n && _res == rhs._res; }
+
+                        bool operator!=(const const_iterator &rhs) const { return !(*this == rhs); }
+
+                    protected:
+                        const columnar_result *_res;
+                        size_t _n;
+                };
+
+                using iterator = const_iterator;
+
+                // Constructors
+                columnar_result() {};
+
+                columnar_result(std::shared_ptr<const row_schema> schema) : _schema(std::move(schema)) {
+                    if (_schema) {
+                        for (size_t i = 0; i < _schema->size(); ++i) {
+                            _columns.emplace_back(_schema->name(i), _schema->type(i));
+                        }
+                    }
+                }
+
+                void add_column(std::string name, data_type type) {
+                    row_schema::set_column(_schema, _columns.size(), name, type);
+                    _columns.emplace_back(name, type);
+                }
+
+                // Sizes
+                size_t size() const noexcept { return _columns.empty() ? 0 : _columns[0].size(); }
+
+                size_t size_rows() const noexcept { return this->size(); }
+
+                size_t size_columns() const noexcept { return _columns.size(); }
+
+                size_t columns() const noexcept { return _columns.size(); }
+
+                bool empty() const noexcept { return this->size() == 0; }
+
+                // Column access
+                column &get_column(size_t n) { return _columns[n]; }
+
+                const column &get_column(size_t n) const { return _columns[n]; }
+
+                // Throws std::out_of_range if there is no such column
+                const column &get_column(const std::string &s) const {
+                    const size_t n = this->column_number(s);
+                    if (n >= _columns.size()) {
+                        throw std::out_of_range("columnar_result::get_column: no column " + s);
+                    }
+                    return _columns[n];
+                }
+
+                // Column number from name (columns() if there is no such column)
+                size_t column_number(const char column_name[]) const {
+                    return _schema ? _schema->column_number(column_name) : _columns.size();
+                }
+
+                size_t column_number(const std::string &column_name) const {
+                    return _schema ? _schema->column_number(column_name) : _columns.size();
+                }
+
+                size_t column_number(column_handle &h) const {
+                    return h.column_number(_schema);
+                }
+
+                const column &get_column(column_handle &h) const {
+                    const size_t n = this->column_number(h);
+                    if (n >= _columns.size()) {
+                        throw std::out_of_range("columnar_result::get_column: no column " + h.name());
+                    }
+                    return _columns[n];
+                }
+
+                const std::shared_ptr<const row_schema> &schema() const noexcept { return _schema; }
+
+                std::string column_name(size_t n) const { return _columns[n].name(); }
+
+                data_type column_type(size_t n) const { return _columns[n].type(); }
+
+                // Row access
+                row_reference operator[](size_t n) const { return row_reference(this, n); }
+
+                row_reference at(size_t n) const {
+                    if (n >= this->size()) {
+                        throw std::out_of_range("columnar_result::at");
+                    }
+                    return row_reference(this, n);
+                }
+
+                const_iterator begin() const { return const_iterator(this, 0); }
+
+                const_iterator end() const { return const_iterator(this, this->size()); }
+
+                void clear() {
+                    _columns.clear();
+                    _schema.reset();
+                }
+
+            protected:
+                std::shared_ptr<const row_schema> _schema;
+                std::vector<column> _columns;
         };
     }
 }
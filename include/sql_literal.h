@@ -0,0 +1,296 @@
+//
+// Queries known at compile time: placeholders counted, named and rewritten by the compiler
+//
+#ifndef WPP_SQL_LITERAL_H
+#define WPP_SQL_LITERAL_H
+
+#include <cstddef>
+#include <string>
+
+namespace wpp {
+    namespace db {
+        ///////////////////////////////////////////////////////////////
+        //                    CONSTEXPR SQL SCANNER                  //
+        ///////////////////////////////////////////////////////////////
+        // Same tokens as data_object_statement::scan: quoted strings and comments are skipped,
+        // "::" casts and "??" are text, ":name" is a named placeholder and "?" a positional one
+        enum literal_token_kind {
+            LITERAL_TEXT = 0,
+            LITERAL_NAMED = 1,
+            LITERAL_POSITIONAL = 2
+        };
+
+        struct literal_token {
+            size_t length;
+            int kind;
+        };
+
+        constexpr bool literal_is_name_char(char c) {
+            return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+        }
+
+        constexpr bool literal_is_alnum(char c) {
+            return literal_is_name_char(c) && c != '_';
+        }
+
+        constexpr literal_token literal_next_token(const char *q, size_t i, size_t n) {
+            const char c = q[i];
+            size_t j = i + 1;
+            if (c == '\'' || c == '"') {
+                while (j < n) {
+                    if (q[j] == '\\') {
+                        j += 2;
+                    } else if (q[j] == c) {
+                        return literal_token{j + 1 - i, LITERAL_TEXT};
+                    } else {
+                        ++j;
+                    }
+                }
+                /* unterminated: the quote alone is text */
+                return literal_token{1, LITERAL_TEXT};
+            }
+            if (c == '-' && j < n && q[j] == '-') {
+                while (j < n && q[j] != '\n' && q[j] != '\r') {
+                    ++j;
+                }
+                return literal_token{j - i, LITERAL_TEXT};
+            }
+            if (c == '/' && j < n && q[j] == '*') {
+                for (j = i + 2; j + 1 < n; ++j) {
+                    if (q[j] == '*' && q[j + 1] == '/') {
+                        return literal_token{j + 2 - i, LITERAL_TEXT};
+                    }
+                }
+                /* unterminated: the slash alone is text, and placeholders after it still count */
+                return literal_token{1, LITERAL_TEXT};
+            }
+            if (c == ':') {
+                if (j < n && q[j] == ':') {
+                    while (j < n && q[j] == ':') {
+                        ++j;
+                    }
+                    return literal_token{j - i, LITERAL_TEXT};
+                }
+                while (j < n && literal_is_name_char(q[j])) {
+                    ++j;
+                }
+                if (j == i + 1 || (i > 0 && literal_is_alnum(q[i - 1]))) {
+                    return literal_token{j - i, LITERAL_TEXT};
+                }
+                return literal_token{j - i, LITERAL_NAMED};
+            }
+            if (c == '?') {
+                if (j < n && q[j] == '?') {
+                    while (j < n && q[j] == '?') {
+                        ++j;
+                    }
+                    return literal_token{j - i, LITERAL_TEXT};
+                }
+                return literal_token{1, LITERAL_POSITIONAL};
+            }
+            return literal_token{1, LITERAL_TEXT};
+        }
+
+        constexpr size_t literal_placeholder_count(const char *q, size_t n) {
+            size_t count = 0;
+            for (size_t i = 0; i < n;) {
+                const literal_token t = literal_next_token(q, i, n);
+                if (t.kind != LITERAL_TEXT) {
+                    ++count;
+                }
+                i += t.length;
+            }
+            return count;
+        }
+
+        constexpr bool literal_equal(const char *a, size_t a_size, const char *b, size_t b_size) {
+            if (a_size != b_size) {
+                return false;
+            }
+            for (size_t i = 0; i < a_size; ++i) {
+                if (a[i] != b[i]) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        // Placeholders of a query with N of them (N + 1 so that the arrays are never empty)
+        template<size_t N>
+        struct literal_layout {
+            int query_type{0};
+            size_t count{0};
+            size_t position[N + 1]{};
+            size_t length[N + 1]{};
+            // index of the parameter each placeholder binds: repeated names share one
+            size_t parameter[N + 1]{};
+            size_t parameters{0};
+        };
+
+        template<size_t N>
+        constexpr literal_layout<N> literal_scan(const char *q, size_t n) {
+            literal_layout<N> layout;
+            for (size_t i = 0; i < n;) {
+                const literal_token t = literal_next_token(q, i, n);
+                if (t.kind != LITERAL_TEXT) {
+                    const size_t k = layout.count++;
+                    layout.query_type |= t.kind;
+                    layout.position[k] = i;
+                    layout.length[k] = t.length;
+                    layout.parameter[k] = layout.parameters;
+                    for (size_t prev = 0; t.kind == LITERAL_NAMED && prev < k; ++prev) {
+                        if (literal_equal(q + layout.position[prev], layout.length[prev], q + i, t.length)) {
+                            layout.parameter[k] = layout.parameter[prev];
+                            break;
+                        }
+                    }
+                    if (layout.parameter[k] == layout.parameters) {
+                        ++layout.parameters;
+                    }
+                }
+                i += t.length;
+            }
+            return layout;
+        }
+
+        ///////////////////////////////////////////////////////////////
+        //                        STATIC STRING                      //
+        ///////////////////////////////////////////////////////////////
+        template<size_t N>
+        struct static_string {
+            char data[N + 1]{};
+            size_t size{0};
+
+            constexpr void append(char c) {
+                data[size++] = c;
+            }
+
+            constexpr void append(const char *s, size_t n) {
+                for (size_t i = 0; i < n; ++i) {
+                    append(s[i]);
+                }
+            }
+
+            constexpr void append_number(size_t value) {
+                char digits[20]{};
+                size_t n = 0;
+                do {
+                    digits[n++] = char('0' + value % 10);
+                    value /= 10;
+                } while (value);
+                while (n) {
+                    append(digits[--n]);
+                }
+            }
+
+            constexpr const char *c_str() const { return data; }
+
+            std::string str() const { return std::string(data, size); }
+        };
+
+        ///////////////////////////////////////////////////////////////
+        //                         SQL LITERAL                       //
+        ///////////////////////////////////////////////////////////////
+        // Text is a type with static constexpr value() and size(), as made by SQL_LITERAL
+        template<typename Text>
+        struct sql_literal {
+            static constexpr const char *text() { return Text::value(); }
+
+            static constexpr size_t size() { return Text::size(); }
+
+            static constexpr size_t placeholder_count() { return literal_placeholder_count(text(), size()); }
+
+            using layout_type = literal_layout<literal_placeholder_count(Text::value(), Text::size())>;
+
+            static constexpr layout_type layout() {
+                return literal_scan<literal_placeholder_count(Text::value(), Text::size())>(text(), size());
+            }
+
+            // Values the query takes: placeholders, counting a repeated name once
+            static constexpr size_t parameter_count() { return layout().parameters; }
+
+            static constexpr bool is_named() { return layout().query_type == LITERAL_NAMED; }
+
+            // Parameter bound by a placeholder name (with the colon), or -1
+            static constexpr long parameter_index(const char *name, size_t name_size) {
+                const layout_type l = layout();
+                for (size_t k = 0; k < l.count; ++k) {
+                    if (literal_equal(text() + l.position[k], l.length[k], name, name_size)) {
+                        return (long) l.parameter[k];
+                    }
+                }
+                return -1;
+            }
+
+            static_assert(literal_scan<literal_placeholder_count(Text::value(), Text::size())>(
+                    Text::value(), Text::size()).query_type != (LITERAL_NAMED | LITERAL_POSITIONAL),
+                          "mixed named and positional parameters");
+
+            // Placeholders as $1, $2... (PostgreSQL), a repeated name keeping its number
+            static constexpr static_string<Text::size() + 4 * literal_placeholder_count(Text::value(), Text::size())>
+            numbered_text() {
+                static_string<Text::size() + 4 * literal_placeholder_count(Text::value(), Text::size())> out;
+                rewrite(out, true);
+                return out;
+            }
+
+            // Placeholders as ? (one per occurrence)
+            static constexpr static_string<Text::size()> positional_text() {
+                static_string<Text::size()> out;
+                rewrite(out, false);
+                return out;
+            }
+
+            static const std::string &numbered() {
+                static const std::string s = numbered_text().str();
+                return s;
+            }
+
+            static const std::string &positional() {
+                static const std::string s = positional_text().str();
+                return s;
+            }
+
+            static const std::string &str() {
+                static const std::string s(text(), size());
+                return s;
+            }
+
+        protected:
+            template<typename Out>
+            static constexpr void rewrite(Out &out, bool numbered) {
+                const layout_type l = layout();
+                size_t i = 0;
+                for (size_t k = 0; k < l.count; ++k) {
+                    out.append(text() + i, l.position[k] - i);
+                    if (numbered) {
+                        out.append('$');
+                        out.append_number(l.parameter[k] + 1);
+                    } else {
+                        out.append('?');
+                    }
+                    i = l.position[k] + l.length[k];
+                }
+                out.append(text() + i, size() - i);
+            }
+        };
+
+        template<typename Text>
+        sql_literal<Text> make_sql_literal(Text) {
+            return sql_literal<Text>();
+        }
+    }
+}
+
+// A string literal whose placeholders are parsed at compile time:
+//     con->prepare(SQL_LITERAL("SELECT * FROM employee WHERE name = :name"))
+#define SQL_LITERAL(text)                                                                    \
+    (::wpp::db::make_sql_literal([]() {                                                     \
+        struct sql_literal_text {                                                            \
+            static constexpr const char *value() { return text; }                            \
+            static constexpr size_t size() { return sizeof(text) - 1; }                      \
+        };                                                                                   \
+        return sql_literal_text{};                                                           \
+    }()))
+
+#endif //WPP_SQL_LITERAL_H
@@ -0,0 +1,455 @@
+//
+// The byte-at-a-time scanner that data_object_statement::scan used before its
+// text and quoted-string runs were skipped with scan_until_any, kept as the
+// reference for the scanner's differential test and benchmark. Its only change
+// since is the one scan() got: an unterminated block comment is a lone '/'.
+//
+#ifndef WPP_TEST_REFERENCE_SCAN_H
+#define WPP_TEST_REFERENCE_SCAN_H
+
+#include "data_object.h"
+
+namespace wpp {
+    namespace db {
+        namespace test {
+            inline int reference_scan(scanner *s) {
+                char *cursor = s->cur;
+                s->tok = cursor;
+                {
+                    unsigned char yych;
+                    if ((s->end - cursor) < 2) {
+                        s->cur = cursor;
+                        return 4;
+                    }
+                    yych = *cursor;
+                    switch (yych) {
+                        case 0x00:
+                            goto yy2;
+                        case '"':
+                            goto yy3;
+                        case '\'':
+                            goto yy5;
+                        case '(':
+                        case ')':
+                        case '*':
+                        case '+':
+                        case ',':
+                        case '.':
+                            goto yy9;
+                        case '-':
+                            goto yy10;
+                        case '/':
+                            goto yy11;
+                        case ':':
+                            goto yy6;
+                        case '?':
+                            goto yy7;
+                        default:
+                            goto yy12;
+                    }
+                    yy2:
+                    cursor = s->ptr;
+                    goto yy4;
+                    yy3:
+                    yych = *(s->ptr = ++cursor);
+                    if (yych >= 0x01) {
+                        goto yy37;
+                    }
+                    yy4:
+                    {
+                        {
+                            s->cur = s->tok + 1;
+                            return PARSER_TEXT;
+                        }
+                    }
+                    yy5:
+                    yych = *(s->ptr = ++cursor);
+                    if (yych <= 0x00) {
+                        goto yy4;
+                    }
+                    goto yy32;
+                    yy6:
+                    yych = *++cursor;
+                    switch (yych) {
+                        case '0':
+                        case '1':
+                        case '2':
+                        case '3':
+                        case '4':
+                        case '5':
+                        case '6':
+                        case '7':
+                        case '8':
+                        case '9':
+                        case 'A':
+                        case 'B':
+                        case 'C':
+                        case 'D':
+                        case 'E':
+                        case 'F':
+                        case 'G':
+                        case 'H':
+                        case 'I':
+                        case 'J':
+                        case 'K':
+                        case 'L':
+                        case 'M':
+                        case 'N':
+                        case 'O':
+                        case 'P':
+                        case 'Q':
+                        case 'R':
+                        case 'S':
+                        case 'T':
+                        case 'U':
+                        case 'V':
+                        case 'W':
+                        case 'X':
+                        case 'Y':
+                        case 'Z':
+                        case '_':
+                        case 'a':
+                        case 'b':
+                        case 'c':
+                        case 'd':
+                        case 'e':
+                        case 'f':
+                        case 'g':
+                        case 'h':
+                        case 'i':
+                        case 'j':
+                        case 'k':
+                        case 'l':
+                        case 'm':
+                        case 'n':
+                        case 'o':
+                        case 'p':
+                        case 'q':
+                        case 'r':
+                        case 's':
+                        case 't':
+                        case 'u':
+                        case 'v':
+                        case 'w':
+                        case 'x':
+                        case 'y':
+                        case 'z':
+                            goto yy26;
+                        case ':':
+                            goto yy29;
+                        default:
+                            goto yy4;
+                    }
+                    yy7:
+                    ++cursor;
+                    switch ((yych = *cursor)) {
+                        case '?':
+                            goto yy23;
+                        default:
+                            goto yy8;
+                    }
+                    yy8:
+                    {
+                        {
+                            s->cur = cursor;
+                            return PARSER_BIND_POS;
+                        }
+                    }
+                    yy9:
+                    yych = *++cursor;
+                    goto yy4;
+                    yy10:
+                    yych = *++cursor;
+                    switch (yych) {
+                        case '-':
+                            goto yy21;
+                        default:
+                            goto yy4;
+                    }
+                    yy11:
+                    yych = *(s->ptr = ++cursor);
+                    switch (yych) {
+                        case '*':
+                            goto yy15;
+                        default:
+                            goto yy4;
+                    }
+                    yy12:
+                    ++cursor;
+                    if (s->end <= cursor) {
+                        s->cur = cursor;
+                        return 4;
+                    }
+                    yych = *cursor;
+                    switch (yych) {
+                        case 0x00:
+                        case '"':
+                        case '\'':
+                        case '(':
+                        case ')':
+                        case '*':
+                        case '+':
+                        case ',':
+                        case '-':
+                        case '.':
+                        case '/':
+                        case ':':
+                        case '?':
+                            goto yy14;
+                        default:
+                            goto yy12;
+                    }
+                    yy14:
+                    {
+                        {
+                            s->cur = cursor;
+                            return PARSER_TEXT;
+                        }
+                    }
+                    yy15:
+                    ++cursor;
+                    if (s->end <= cursor) {
+                        /* unterminated comment: like an unterminated quote, the slash alone is text */
+                        goto yy4;
+                    }
+                    yych = *cursor;
+                    switch (yych) {
+                        case '*':
+                            goto yy17;
+                        default:
+                            goto yy15;
+                    }
+                    yy17:
+                    ++cursor;
+                    if (s->end <= cursor) {
+                        /* unterminated comment: like an unterminated quote, the slash alone is text */
+                        goto yy4;
+                    }
+                    yych = *cursor;
+                    switch (yych) {
+                        case '*':
+                            goto yy17;
+                        case '/':
+                            goto yy19;
+                        default:
+                            goto yy15;
+                    }
+                    yy19:
+                    ++cursor;
+                    yy20:
+                    {
+                        {
+                            s->cur = cursor;
+                            return PARSER_TEXT;
+                        }
+                    }
+                    yy21:
+                    ++cursor;
+                    if (s->end <= cursor) {
+                        s->cur = cursor;
+                        return 4;
+                    }
+                    yych = *cursor;
+                    switch (yych) {
+                        case '\n':
+                        case '\r':
+                            goto yy20;
+                        default:
+                            goto yy21;
+                    }
+                    yy23:
+                    ++cursor;
+                    if (s->end <= cursor) {
+                        s->cur = cursor;
+                        return 4;
+                    }
+                    yych = *cursor;
+                    switch (yych) {
+                        case '?':
+                            goto yy23;
+                        default:
+                            goto yy25;
+                    }
+                    yy25:
+                    {
+                        {
+                            s->cur = cursor;
+                            return PARSER_TEXT;
+                        }
+                    }
+                    yy26:
+                    ++cursor;
+                    if (s->end <= cursor) {
+                        s->cur = cursor;
+                        return 4;
+                    }
+                    yych = *cursor;
+                    switch (yych) {
+                        case '0':
+                        case '1':
+                        case '2':
+                        case '3':
+                        case '4':
+                        case '5':
+                        case '6':
+                        case '7':
+                        case '8':
+                        case '9':
+                        case 'A':
+                        case 'B':
+                        case 'C':
+                        case 'D':
+                        case 'E':
+                        case 'F':
+                        case 'G':
+                        case 'H':
+                        case 'I':
+                        case 'J':
+                        case 'K':
+                        case 'L':
+                        case 'M':
+                        case 'N':
+                        case 'O':
+                        case 'P':
+                        case 'Q':
+                        case 'R':
+                        case 'S':
+                        case 'T':
+                        case 'U':
+                        case 'V':
+                        case 'W':
+                        case 'X':
+                        case 'Y':
+                        case 'Z':
+                        case '_':
+                        case 'a':
+                        case 'b':
+                        case 'c':
+                        case 'd':
+                        case 'e':
+                        case 'f':
+                        case 'g':
+                        case 'h':
+                        case 'i':
+                        case 'j':
+                        case 'k':
+                        case 'l':
+                        case 'm':
+                        case 'n':
+                        case 'o':
+                        case 'p':
+                        case 'q':
+                        case 'r':
+                        case 's':
+                        case 't':
+                        case 'u':
+                        case 'v':
+                        case 'w':
+                        case 'x':
+                        case 'y':
+                        case 'z':
+                            goto yy26;
+                        default:
+                            goto yy28;
+                    }
+                    yy28:
+                    {
+                        {
+                            s->cur = cursor;
+                            return PARSER_BIND;
+                        }
+                    }
+                    yy29:
+                    ++cursor;
+                    if (s->end <= cursor) {
+                        s->cur = cursor;
+                        return 4;
+                    }
+                    yych = *cursor;
+                    switch (yych) {
+                        case ':':
+                            goto yy29;
+                        default:
+                            goto yy25;
+                    }
+                    yy31:
+                    ++cursor;
+                    if (s->end <= cursor) {
+                        s->cur = cursor;
+                        return 4;
+                    }
+                    yych = *cursor;
+                    yy32:
+                    switch (yych) {
+                        case 0x00:
+                            goto yy2;
+                        case '\'':
+                            goto yy34;
+                        case '\\':
+                            goto yy33;
+                        default:
+                            goto yy31;
+                    }
+                    yy33:
+                    ++cursor;
+                    if (s->end <= cursor) {
+                        s->cur = cursor;
+                        return 4;
+                    }
+                    yych = *cursor;
+                    if (yych <= 0x00) {
+                        goto yy2;
+                    }
+                    goto yy31;
+                    yy34:
+                    ++cursor;
+                    {
+                        {
+                            s->cur = cursor;
+                            return PARSER_TEXT;
+                        }
+                    }
+                    yy36:
+                    ++cursor;
+                    if (s->end <= cursor) {
+                        s->cur = cursor;
+                        return 4;
+                    }
+                    yych = *cursor;
+                    yy37:
+                    switch (yych) {
+                        case 0x00:
+                            goto yy2;
+                        case '"':
+                            goto yy39;
+                        case '\\':
+                            goto yy38;
+                        default:
+                            goto yy36;
+                    }
+                    yy38:
+                    ++cursor;
+                    if (s->end <= cursor) {
+                        s->cur = cursor;
+                        return 4;
+                    }
+                    yych = *cursor;
+                    if (yych <= 0x00) {
+                        goto yy2;
+                    }
+                    goto yy36;
+                    yy39:
+                    ++cursor;
+                    {
+                        {
+                            s->cur = cursor;
+                            return PARSER_TEXT;
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+#endif //WPP_TEST_REFERENCE_SCAN_H
@@ -0,0 +1,73 @@
+//
+// Throughput of data_object_statement::scan against the byte-at-a-time
+// reference scanner on large generated INSERT statements.
+//
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include "data_object.h"
+#include "reference_scan.h"
+
+using namespace wpp::db;
+
+struct statement_scanner : public data_object_statement {
+    static int next(scanner *s) {
+        return scan(s);
+    }
+};
+
+// Number of placeholders, so that the scan cannot be optimized away
+template<class Scan>
+size_t count_binds(std::string &query, Scan next) {
+    scanner s;
+    s.ptr = &query[0];
+    s.cur = &query[0];
+    s.end = &query[0] + query.size() + 1;
+    size_t binds = 0;
+    int t;
+    while ((t = next(&s)) != PARSER_EOI) {
+        binds += t != PARSER_TEXT;
+    }
+    return binds;
+}
+
+// Best of a few runs, in MB/s
+template<class Scan>
+double throughput(std::string &query, Scan next, size_t &binds) {
+    double best = 1e9;
+    for (int run = 0; run < 30; ++run) {
+        auto start = std::chrono::steady_clock::now();
+        binds += count_binds(query, next);
+        auto finish = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double>(finish - start).count());
+    }
+    return query.size() / best / 1e6;
+}
+
+void report(const std::string &name, std::string query) {
+    size_t binds = 0;
+    const double before = throughput(query, test::reference_scan, binds);
+    const double after = throughput(query, statement_scanner::next, binds);
+    std::cout << name << " (" << query.size() / 1000 << " kB): reference " << before << " MB/s, scan() " << after
+              << " MB/s (" << binds << ")" << std::endl;
+}
+
+int main() {
+    std::string rows = "INSERT INTO log(id, name, payload, note) VALUES ";
+    for (int i = 0; i < 40000; ++i) {
+        rows += "(" + std::to_string(i) + ", 'user name number " + std::to_string(i) +
+                "', 'some longer payload text with spaces and words in it to skip', :note),\n";
+    }
+    rows += "(0, '', '', ?)";
+    std::string documents = "INSERT INTO events(id, doc) VALUES ";
+    for (int i = 0; i < 4000; ++i) {
+        documents += "(" + std::to_string(i) + ", '{\"type\": \"click\", \"target\": \"button number " +
+                     std::string(400, 'x') + "\", \"ok\": true}'),\n";
+    }
+    documents += "(0, ?)";
+    std::cout << "scan_until_any level " << best_scan_simd_level() << std::endl;
+    report("multi-row insert", rows);
+    report("long strings", documents);
+    return 0;
+}
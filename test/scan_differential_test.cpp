@@ -0,0 +1,201 @@
+//
+// Checks that data_object_statement::scan, which skips runs of text with
+// scan_until_any, returns the same tokens as the byte-at-a-time reference
+// scanner, that the constexpr scanner of SQL_LITERAL finds the same
+// placeholders, and that every scan_until_any level finds the same stop byte.
+//
+#include <cctype>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "data_object.h"
+#include "reference_scan.h"
+
+using namespace wpp::db;
+
+struct token {
+    int type;
+    ptrdiff_t begin;
+    ptrdiff_t end;
+
+    bool operator==(const token &other) const {
+        return type == other.type && begin == other.begin && end == other.end;
+    }
+};
+
+struct statement_scanner : public data_object_statement {
+    static int next(scanner *s) {
+        return scan(s);
+    }
+};
+
+template<class Scan>
+std::vector<token> tokens(std::string &query, Scan next) {
+    /* offsets are taken from the start of the query: the scanner uses ptr as its backtracking marker */
+    char *begin = &query[0];
+    scanner s;
+    s.ptr = begin;
+    s.cur = begin;
+    /* the statement scans the terminating NUL too */
+    s.end = begin + query.size() + 1;
+    std::vector<token> result;
+    int t;
+    while ((t = next(&s)) != PARSER_EOI) {
+        result.push_back({t, s.tok - begin, s.cur - begin});
+    }
+    result.push_back({t, s.tok - begin, s.cur - begin});
+    return result;
+}
+
+// Placeholders as parse_params keeps them: a ":name" right after an alphanumeric character is text
+std::vector<token> runtime_placeholders(std::string &query) {
+    std::vector<token> result;
+    for (const token &t : tokens(query, statement_scanner::next)) {
+        if (t.type == PARSER_BIND && t.begin > 0 && std::isalnum((unsigned char) query[t.begin - 1])) {
+            continue;
+        }
+        if (t.type == PARSER_BIND || t.type == PARSER_BIND_POS) {
+            result.push_back({t.type == PARSER_BIND ? LITERAL_NAMED : LITERAL_POSITIONAL, t.begin, t.end});
+        }
+    }
+    return result;
+}
+
+std::vector<token> literal_placeholders(const std::string &query) {
+    std::vector<token> result;
+    for (size_t i = 0; i < query.size();) {
+        const literal_token t = literal_next_token(query.data(), i, query.size());
+        if (t.kind != LITERAL_TEXT) {
+            result.push_back({t.kind, (ptrdiff_t) i, (ptrdiff_t) (i + t.length)});
+        }
+        i += t.length;
+    }
+    return result;
+}
+
+static_assert(literal_placeholder_count("SELECT :a /* :b", 15) == 2, "an unterminated comment is a lone slash");
+
+int failures = 0;
+
+void check_query(std::string query) {
+    std::string copy = query;
+    const std::vector<token> expected = tokens(query, test::reference_scan);
+    const std::vector<token> found = tokens(copy, statement_scanner::next);
+    if (expected != found) {
+        if (++failures <= 10) {
+            std::cerr << "scan() differs from the reference on: " << query << std::endl;
+        }
+    }
+    /* string literals end at their first NUL */
+    if (query.find('\0') == std::string::npos && literal_placeholders(query) != runtime_placeholders(copy)) {
+        if (++failures <= 10) {
+            std::cerr << "SQL_LITERAL finds other placeholders than scan() on: " << query << std::endl;
+        }
+    }
+}
+
+std::string random_query(std::mt19937 &rng) {
+    static const std::string alphabet = "abcXYZ019 _\n\r\t(),.*+-/:?'\"\\;=$\x01\x7f\xff";
+    std::string query;
+    const size_t pieces = rng() % 200;
+    for (size_t k = 0; k < pieces; ++k) {
+        const unsigned r = rng() % 100;
+        if (r < 50) {
+            query += alphabet[rng() % alphabet.size()];
+        } else if (r < 70) {
+            query += std::string(rng() % 70, (char) ('a' + rng() % 26));
+        } else if (r < 80) {
+            query += "'" + std::string(rng() % 70, 'q') + (rng() % 4 ? "'" : "");
+        } else if (r < 88) {
+            query += "\"" + std::string(rng() % 70, 'w') + (rng() % 4 ? "\"" : "");
+        } else if (r < 92) {
+            query += "/*" + std::string(rng() % 40, 'c') + (rng() % 4 ? "*/" : "");
+        } else if (r < 96) {
+            query += "-- " + std::string(rng() % 40, 'd') + "\n";
+        } else if (r < 98) {
+            query += "::int";
+        } else {
+            query += std::string(1, '\0');
+        }
+    }
+    return query;
+}
+
+// Every stop byte, and a few bytes that are not stops, at each offset around the 16 and 32 byte blocks
+void check_adversarial() {
+    const std::string specials = std::string("'\"\\:?()*+,-./", 13) + std::string(1, '\0') + "\x80\xff";
+    for (char special : specials) {
+        for (size_t length = 0; length < 100; ++length) {
+            for (size_t at = 0; at < length; ++at) {
+                std::string run(length, 'x');
+                run[at] = special;
+                check_query(run);
+                check_query("SELECT " + run + " FROM t WHERE a = ?");
+                check_query("'" + run + "' ");
+                check_query("\"" + run + "\" ");
+                check_query("'" + run);
+            }
+        }
+    }
+}
+
+template<char... Stops>
+char *naive_until_any(char *cursor, char *end) {
+    const char stops[] = {Stops...};
+    for (; cursor < end; ++cursor) {
+        for (char c : stops) {
+            if (*cursor == c) {
+                return cursor;
+            }
+        }
+    }
+    return end;
+}
+
+template<char... Stops>
+void check_levels(std::mt19937 &rng) {
+    std::vector<scan_simd_level> levels = {SCAN_SCALAR};
+    if (best_scan_simd_level() >= SCAN_SSE42) {
+        levels.push_back(SCAN_SSE42);
+    }
+    if (best_scan_simd_level() >= SCAN_AVX2) {
+        levels.push_back(SCAN_AVX2);
+    }
+    const char stops[] = {Stops...};
+    for (int i = 0; i < 20000; ++i) {
+        std::string text(rng() % 130, 'a');
+        for (char &c : text) {
+            c = rng() % 8 ? (char) ('a' + rng() % 26) : (char) (rng() % 256);
+        }
+        if (!text.empty() && rng() % 2) {
+            text[rng() % text.size()] = stops[rng() % sizeof(stops)];
+        }
+        char *begin = &text[0];
+        char *end = begin + text.size();
+        const char *expected = naive_until_any<Stops...>(begin, end);
+        for (scan_simd_level level : levels) {
+            if (scan_until_any<Stops...>(begin, end, level) != expected) {
+                if (++failures <= 10) {
+                    std::cerr << "scan_until_any level " << level << " differs on " << text.size() << " bytes"
+                              << std::endl;
+                }
+            }
+        }
+    }
+}
+
+int main() {
+    std::mt19937 rng(42);
+    for (int i = 0; i < 50000; ++i) {
+        check_query(random_query(rng));
+    }
+    check_adversarial();
+    check_query("SELECT :a /* :b");
+    check_query("SELECT ? /* ? */ ? -- ?\n?");
+    check_levels<'\0', '"', '\'', '(', ')', '*', '+', ',', '-', '.', '/', ':', '?'>(rng);
+    check_levels<'\0', '\'', '\\'>(rng);
+    check_levels<'\0', '"', '\\'>(rng);
+    std::cout << "scan_until_any level " << best_scan_simd_level() << ", " << failures << " failures" << std::endl;
+    return failures == 0 ? 0 : 1;
+}
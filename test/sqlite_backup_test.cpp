@@ -0,0 +1,76 @@
+//
+// Round trips an in-memory database through snapshot/restore and through the
+// online backup API, to a file and to another connection, and checks that
+// failures leave their SQLSTATE in the connection.
+//
+#include <iostream>
+#include <cstdio>
+#include <string>
+#include "driver/sqlite.h"
+
+using namespace wpp::db;
+
+int failures = 0;
+
+void check(bool ok, const std::string &what) {
+    if (!ok && ++failures <= 10) {
+        std::cerr << "failed: " << what << std::endl;
+    }
+}
+
+std::string count(sqlite &con) {
+    sqlite::stmt q = con.query("SELECT count(*) FROM t");
+    return q ? std::string(q->fetch()[0]) : "";
+}
+
+int main() {
+    const std::string path = "sqlite_backup_test.db";
+    std::remove(path.c_str());
+
+    sqlite source;
+    source.exec("CREATE TABLE t(id INTEGER PRIMARY KEY, v TEXT)");
+    source.begin_transaction();
+    sqlite::stmt insert = source.prepare("INSERT INTO t(v) VALUES (?)");
+    for (int i = 0; i < 5000; ++i) {
+        std::string v = "value " + std::to_string(i);
+        insert->bind_value(1, v);
+        insert->execute();
+    }
+    source.commit();
+
+    std::string image;
+    check(source.snapshot(image) && !image.empty(), "snapshot an in-memory database");
+    sqlite restored;
+    check(restored.restore(image) && count(restored) == "5000", "restore the snapshot");
+    check(restored.exec("INSERT INTO t(v) VALUES ('grows')") == 1 && count(restored) == "5001",
+          "a restored database grows");
+    check(!restored.restore(image, "nosuch") && restored.error_code() == "HY000",
+          "restoring into a missing database fails");
+
+    sqlite_backup backup = source.backup_to(path);
+    int steps = 0;
+    while (backup.step(10)) {
+        if (++steps == 1) {
+            source.exec("INSERT INTO t(v) VALUES ('during')");
+        }
+    }
+    check(backup.done() && backup.finish(), "back up to a file");
+
+    sqlite warm;
+    sqlite_backup load = warm.restore_from(path);
+    load.step(-1);
+    check(load.done() && load.finish() && count(warm) == "5001", "restore_from the file");
+
+    sqlite other;
+    sqlite_backup copy = warm.backup_to(other);
+    while (copy.step()) {
+    }
+    check(copy.finish() && count(other) == "5001", "back up to another connection");
+
+    sqlite_backup missing = warm.restore_from("no_such_directory/x.db");
+    check(!missing && warm.error_code() == "HY000", "restore_from a missing file fails");
+
+    std::remove(path.c_str());
+    std::cout << failures << " failures" << std::endl;
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,56 @@
+//
+// Writes a BLOB with zeros in it through sqlite_blob_writer in uneven chunks,
+// reads it back with sqlite_blob_reader, and checks that failures leave their
+// SQLSTATE in the connection.
+//
+#include <iostream>
+#include <string>
+#include "driver/sqlite.h"
+
+using namespace wpp::db;
+
+int failures = 0;
+
+void check(bool ok, const std::string &what) {
+    if (!ok && ++failures <= 10) {
+        std::cerr << "failed: " << what << std::endl;
+    }
+}
+
+int main() {
+    sqlite con;
+    con.exec("CREATE TABLE files(id INTEGER PRIMARY KEY, data BLOB)");
+    std::string payload(300000, '\0');
+    for (size_t i = 0; i < payload.size(); ++i) {
+        payload[i] = (char) (i % 7 ? i * 31 : 0);
+    }
+    con.exec("INSERT INTO files(id, data) VALUES (1, zeroblob(" + std::to_string(payload.size()) + "))");
+    con.exec("INSERT INTO files(id, data) VALUES (2, zeroblob(3))");
+
+    sqlite_blob_writer writer = con.blob_writer("files", "data", 1);
+    check((bool) writer && writer.size() == payload.size(), "blob_writer opens the row");
+    for (size_t offset = 0; offset < payload.size(); offset += 10007) {
+        check(writer.write(boost::string_view(payload).substr(offset, 10007)), "write a chunk");
+    }
+    check(!writer.write("x", 1), "a write past the end fails");
+    check(con.error_code() == "22001", "a write past the end is 22001");
+    writer.close();
+
+    sqlite_blob_reader reader = con.blob_reader("files", "data", 1);
+    std::string read;
+    std::string chunk;
+    while (reader.read(chunk, 65521)) {
+        read += chunk;
+    }
+    check(read == payload, "the blob reads back as it was written");
+    check(reader.reopen(2) && reader.size() == 3, "reopen moves to another row");
+    check(reader.seek(1) && reader.read(chunk) && chunk == std::string(2, '\0'), "seek then read the rest");
+    check(!reader.reopen(3) && !reader, "reopen on a missing row closes the reader");
+    check(!con.error_code().empty() && con.error_code() != "00000", "a failed reopen leaves its error");
+
+    check(!con.blob_reader("files", "missing", 1), "blob_reader on a missing column is empty");
+    check(con.error_code() == "HY000", "a failed open is HY000");
+
+    std::cout << failures << " failures" << std::endl;
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,108 @@
+//
+// Checks how sqlite_connection_group routes statements: reads to readers,
+// writes to the writer, transaction control rejected, and reads that keep
+// going on several threads while the writer is leased.
+//
+#include <iostream>
+#include <atomic>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include "driver/sqlite_connection_group.h"
+
+using namespace wpp::db;
+
+int failures = 0;
+
+void check(bool ok, const std::string &what) {
+    if (!ok && ++failures <= 10) {
+        std::cerr << "failed: " << what << std::endl;
+    }
+}
+
+void remove_database(const std::string &path) {
+    std::remove(path.c_str());
+    std::remove((path + "-wal").c_str());
+    std::remove((path + "-shm").c_str());
+}
+
+bool rejected(sqlite_connection_group &group, const std::string &sql) {
+    try {
+        group.query(sql);
+    } catch (std::invalid_argument &) {
+        return true;
+    }
+    return false;
+}
+
+int main() {
+    const std::string path = "sqlite_connection_group_test.db";
+    remove_database(path);
+    bool memory_rejected = false;
+    try {
+        sqlite_connection_group memory(":memory:");
+    } catch (std::invalid_argument &) {
+        memory_rejected = true;
+    }
+    check(memory_rejected, "in-memory databases are rejected");
+    {
+        sqlite_group_options options;
+        options.readers = 4;
+        sqlite_connection_group group(path, options);
+        check(group.exec("CREATE TABLE t(id INTEGER PRIMARY KEY, v TEXT)") == 0, "exec runs on the writer");
+
+        sqlite_connection_group::routed_statement insert = group.prepare("INSERT INTO t(v) VALUES (?)");
+        check(insert && insert.is_write(), "an insert goes to the writer");
+        for (int i = 0; i < 100; ++i) {
+            std::string v = "row" + std::to_string(i);
+            insert->bind_value(1, v);
+            check(insert->execute() != 0, "insert a row");
+        }
+        insert = sqlite_connection_group::routed_statement();
+
+        sqlite_connection_group::routed_statement count = group.query("SELECT count(*) FROM t");
+        check(count && !count.is_write(), "a select goes to a reader");
+        check(count && std::string(count->fetch()[0]) == "100", "the reader sees the writes");
+        count = sqlite_connection_group::routed_statement();
+
+        sqlite_connection_group::routed_statement bad = group.prepare("SELEKT 1");
+        check(!bad && bad.connection() != nullptr, "SQL that does not prepare reports on a connection");
+        bad = sqlite_connection_group::routed_statement();
+
+        for (const char *sql : {"BEGIN", "begin immediate", " /* x */ COMMIT", "-- x\nROLLBACK", "END TRANSACTION",
+                                "SAVEPOINT a", "RELEASE a"}) {
+            check(rejected(group, sql), std::string("transaction control is rejected: ") + sql);
+        }
+        check(!rejected(group, "SELECT 'BEGIN'"), "a select that mentions BEGIN is not rejected");
+
+        {
+            /* a transaction on the writer doesn't stop the readers */
+            sqlite_connection_group::lease writer = group.writer();
+            writer->begin_transaction();
+            writer->exec("INSERT INTO t(v) VALUES ('uncommitted')");
+            std::atomic<long> rows{0};
+            std::vector<std::thread> threads;
+            for (int k = 0; k < 4; ++k) {
+                threads.emplace_back([&]() {
+                    for (int q = 0; q < 10; ++q) {
+                        sqlite_connection_group::routed_statement all = group.query("SELECT v FROM t");
+                        while (all && all->fetch().size()) {
+                            ++rows;
+                        }
+                    }
+                });
+            }
+            for (std::thread &thread : threads) {
+                thread.join();
+            }
+            check(rows == 4 * 10 * 100, "readers only see committed rows");
+            writer->commit();
+        }
+        check(group.size() <= 1 + options.readers, "the group opens at most one writer and its readers");
+    }
+    remove_database(path);
+    std::cout << failures << " failures" << std::endl;
+    return failures == 0 ? 0 : 1;
+}
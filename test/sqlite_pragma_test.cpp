@@ -0,0 +1,69 @@
+//
+// Opens SQLite connections with the sqlite_attribute_type profile and checks
+// that the pragmas are in effect, that read-only opening holds, and that a
+// rejected pragma leaves the connection closed with its error.
+//
+#include <iostream>
+#include <cstdio>
+#include <string>
+#include "driver/sqlite.h"
+
+using namespace wpp::db;
+
+int failures = 0;
+
+void check(bool ok, const std::string &what) {
+    if (!ok && ++failures <= 10) {
+        std::cerr << "failed: " << what << std::endl;
+    }
+}
+
+std::string attribute(data_object &con, long attr) {
+    return con.get_attribute((attribute_type) attr).get_string();
+}
+
+void remove_database(const std::string &path) {
+    std::remove(path.c_str());
+    std::remove((path + "-wal").c_str());
+    std::remove((path + "-shm").c_str());
+}
+
+int main() {
+    const std::string path = "sqlite_pragma_test.db";
+    remove_database(path);
+    {
+        sqlite con("sqlite:" + path, "", "", {
+                {(attribute_type) SQLITE_ATTR_PAGE_SIZE, 8192},
+                {(attribute_type) SQLITE_ATTR_JOURNAL_MODE, std::string("wal")},
+                {(attribute_type) SQLITE_ATTR_SYNCHRONOUS, std::string("NORMAL")},
+                {(attribute_type) SQLITE_ATTR_CACHE_SIZE, -4000},
+                {(attribute_type) SQLITE_ATTR_TEMP_STORE, std::string("MEMORY")},
+                {(attribute_type) SQLITE_ATTR_THREADING_MODE, (int) SQLITE_THREADING_MULTI_THREAD}});
+        check(con.exec("CREATE TABLE t(a)") >= 0 && con.exec("INSERT INTO t VALUES (1)") == 1, "the profile opens");
+        check(attribute(con, SQLITE_ATTR_JOURNAL_MODE) == "wal", "journal_mode is wal");
+        check(attribute(con, SQLITE_ATTR_SYNCHRONOUS) == "1", "synchronous is NORMAL");
+        check(attribute(con, SQLITE_ATTR_CACHE_SIZE) == "-4000", "cache_size is set");
+        check(attribute(con, SQLITE_ATTR_TEMP_STORE) == "2", "temp_store is MEMORY");
+        check(attribute(con, SQLITE_ATTR_PAGE_SIZE) == "8192", "page_size is set before WAL");
+        con.set_attribute((attribute_type) SQLITE_ATTR_CACHE_SIZE, driver_option(100));
+        check(attribute(con, SQLITE_ATTR_CACHE_SIZE) == "100", "set_attribute changes a pragma");
+    }
+    {
+        sqlite con("sqlite:" + path, "", "", {{(attribute_type) SQLITE_ATTR_READ_ONLY, true}});
+        data_object &base = con;
+        check(base.get_attribute((attribute_type) SQLITE_ATTR_READ_ONLY).get_bool(), "the connection is read-only");
+        check(con.exec("INSERT INTO t VALUES (2)") <= 0, "a read-only connection does not write");
+    }
+    {
+        sqlite con("sqlite::memory:", "", "", {{(attribute_type) SQLITE_ATTR_JOURNAL_MODE, std::string("WAL")}});
+        check(con.error_code() == "HY000", "WAL is rejected on :memory:");
+    }
+    {
+        sqlite con("sqlite::memory:", "", "",
+                   {{(attribute_type) SQLITE_ATTR_SYNCHRONOUS, std::string("NORMAL; DROP TABLE t")}});
+        check(con.error_code() == "HY024", "a value that is not a keyword is rejected");
+    }
+    remove_database(path);
+    std::cout << failures << " failures" << std::endl;
+    return failures == 0 ? 0 : 1;
+}